@@ -0,0 +1,123 @@
+#include <stdlib.h>
+
+#include "async_writer.h"
+
+static void* writer_thread(void* arg){
+    async_writer_t* writer=arg;
+
+    pthread_mutex_lock(&writer->lock);
+
+    while(1){
+        while(writer->pending==0 && !writer->stop){
+            pthread_cond_wait(&writer->cond, &writer->lock);
+        }
+
+        if(writer->pending==0 && writer->stop){
+            break;
+        }
+
+        //Write without holding the lock so the producer keeps running
+        size_t len=writer->pending;
+        pthread_mutex_unlock(&writer->lock);
+
+        fwrite(writer->spare, 1, len, writer->fp);
+        fflush(writer->fp);
+
+        pthread_mutex_lock(&writer->lock);
+        writer->bytes_written+=len;
+        writer->pending=0;
+        pthread_cond_broadcast(&writer->cond);
+    }
+
+    pthread_mutex_unlock(&writer->lock);
+
+    return NULL;
+}
+
+async_writer_t* async_writer_open(const char* path, size_t buffer_size){
+    FILE* fp=fopen(path, "wb");
+
+    if(!fp){
+        return NULL;
+    }
+
+    return async_writer_open_stream(fp, buffer_size);
+}
+
+async_writer_t* async_writer_open_stream(FILE* fp, size_t buffer_size){
+    async_writer_t* writer=calloc(1, sizeof(async_writer_t));
+
+    writer->fp=fp;
+    writer->buffer_size=buffer_size;
+    writer->current=malloc(buffer_size);
+    writer->spare=malloc(buffer_size);
+
+    pthread_mutex_init(&writer->lock, NULL);
+    pthread_cond_init(&writer->cond, NULL);
+    pthread_create(&writer->thread, NULL, writer_thread, writer);
+
+    return writer;
+}
+
+//Swap buffers: the full one goes to the thread, its old one comes back empty. Called with the lock held
+static void swap_buffers(async_writer_t* writer){
+    uint8_t* full=writer->current;
+    writer->current=writer->spare;
+    writer->spare=full;
+    writer->pending=writer->used;
+    writer->used=0;
+
+    pthread_cond_broadcast(&writer->cond);
+}
+
+void async_writer_flush(async_writer_t* writer){
+    if(writer->used==0){
+        return;
+    }
+
+    pthread_mutex_lock(&writer->lock);
+
+    while(writer->pending!=0){
+        pthread_cond_wait(&writer->cond, &writer->lock);
+    }
+
+    swap_buffers(writer);
+    pthread_mutex_unlock(&writer->lock);
+}
+
+int async_writer_try_flush(async_writer_t* writer){
+    if(writer->used==0){
+        return 0;
+    }
+
+    //The writer thread only holds the lock between writes, never while blocked in one
+    pthread_mutex_lock(&writer->lock);
+
+    if(writer->pending!=0){
+        pthread_mutex_unlock(&writer->lock);
+        return -1;
+    }
+
+    swap_buffers(writer);
+    pthread_mutex_unlock(&writer->lock);
+
+    return 0;
+}
+
+void async_writer_close(async_writer_t* writer){
+    async_writer_flush(writer);
+
+    pthread_mutex_lock(&writer->lock);
+    writer->stop=1;
+    pthread_cond_broadcast(&writer->cond);
+    pthread_mutex_unlock(&writer->lock);
+
+    pthread_join(writer->thread, NULL);
+
+    fclose(writer->fp);
+    pthread_mutex_destroy(&writer->lock);
+    pthread_cond_destroy(&writer->cond);
+    free(writer->current);
+    free(writer->spare);
+    free(writer);
+}
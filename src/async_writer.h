@@ -0,0 +1,65 @@
+#ifndef async_writer_H
+#define async_writer_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+/*Double-buffered file writer. The producer fills one buffer while a background thread
+writes the other one to disk, so the producer only pays for a memcpy per record*/
+typedef struct{
+    FILE* fp;
+
+    uint8_t* current;           //Buffer being filled by the producer
+    size_t used;
+    size_t buffer_size;
+
+    uint8_t* spare;             //Buffer owned by the writer thread
+    size_t pending;             //Bytes of spare waiting to be written, 0 when idle
+
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int stop;
+
+    uint64_t bytes_written;
+} async_writer_t;
+
+//Returns NULL if the file cannot be created
+async_writer_t* async_writer_open(const char* path, size_t buffer_size);
+
+//Same, for an already open stream such as a socket, which async_writer_close() closes
+async_writer_t* async_writer_open_stream(FILE* fp, size_t buffer_size);
+
+//Flushes everything still buffered and closes the file
+void async_writer_close(async_writer_t* writer);
+
+//Hands the current buffer to the writer thread, waiting if the previous one is still being written
+void async_writer_flush(async_writer_t* writer);
+
+//Same, but returns -1 instead of waiting when the writer thread is still busy
+int async_writer_try_flush(async_writer_t* writer);
+
+//Returns space for len bytes in the current buffer (len must not exceed the buffer size)
+static inline void* async_writer_reserve(async_writer_t* writer, size_t len){
+    if(writer->used+len>writer->buffer_size){
+        async_writer_flush(writer);
+    }
+
+    void* space=writer->current+writer->used;
+    writer->used+=len;
+
+    return space;
+}
+
+//Gives back the unused end of the last reservation, for records whose size is only known afterwards
+static inline void async_writer_unreserve(async_writer_t* writer, size_t len){
+    writer->used-=len;
+}
+
+static inline void async_writer_write(async_writer_t* writer, const void* data, size_t len){
+    memcpy(async_writer_reserve(writer, len), data, len);
+}
+
+#endif
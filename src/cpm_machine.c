@@ -0,0 +1,149 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "cpm_machine.h"
+#include "rom.h"
+
+#define CPM_BATCH_CYCLES	1000000		//Cycles run before the 32-bit CPU counter is folded into cycles
+
+cpm_machine_t* cpm_init(FILE* console){
+    cpm_machine_t* cpm=calloc(1, sizeof(cpm_machine_t));
+
+    cpm->memory=calloc(CPM_MEM_SIZE, sizeof(uint8_t));
+    cpm->console=console;
+
+    cpm->cpu=i8080_init();
+    cpm->cpu->memory=cpm->memory;
+    cpm->cpu->rom_size=0;         //All 64K is RAM
+
+    //BDOS entry jumps to a RET at the top of memory; the word at 0x0006 is also
+    //what programs read to find the top of the TPA for their stack
+    cpm->memory[0x0000]=0x76;     //HLT at warm boot, never executed since 0x0000 is trapped
+    cpm->memory[CPM_BDOS_ENTRY]=0xC3;
+    cpm->memory[CPM_BDOS_ENTRY+1]=CPM_BDOS_STUB & 0xFF;
+    cpm->memory[CPM_BDOS_ENTRY+2]=CPM_BDOS_STUB>>8;
+    cpm->memory[CPM_BDOS_STUB]=0xC9;
+
+    cpm->cpu->PC=CPM_TPA_START;
+    cpm->cpu->SP=CPM_BDOS_STUB;
+
+    return cpm;
+}
+
+void cpm_destroy(cpm_machine_t* cpm){
+    free(cpm->cpu);
+    free(cpm->memory);
+    free(cpm);
+}
+
+int cpm_load_com(cpm_machine_t* cpm, const char* path){
+    char error[ROM_PATH_MAX+64];
+    size_t size;
+    const uint8_t* data=rom_map_file(path, &size, error, sizeof(error));
+
+    if(!data){
+        printf("Cannot load program: %s\n", error);
+        return -1;
+    }
+
+    if(size>CPM_BDOS_STUB-CPM_TPA_START){
+        printf("Cannot load program: %s is %zu bytes, the TPA holds %d\n", path, size, CPM_BDOS_STUB-CPM_TPA_START);
+        rom_unmap_file(data, size);
+        return -1;
+    }
+
+    memcpy(&cpm->memory[CPM_TPA_START], data, size);
+    rom_unmap_file(data, size);
+
+    return 0;
+}
+
+static void flush_output(cpm_machine_t* cpm){
+    fwrite(cpm->output, 1, cpm->output_len, cpm->console);
+    fflush(cpm->console);
+    cpm->output_len=0;
+}
+
+static void output_bytes(cpm_machine_t* cpm, const uint8_t* data, size_t len){
+    while(len>0){
+        size_t n=CPM_OUTPUT_SIZE-cpm->output_len;
+        if(n>len){
+            n=len;
+        }
+
+        memcpy(&cpm->output[cpm->output_len], data, n);
+        cpm->output_len+=n;
+        data+=n;
+        len-=n;
+
+        if(cpm->output_len==CPM_OUTPUT_SIZE){
+            flush_output(cpm);
+        }
+    }
+
+    //Whole lines are written out straight away so long runs show progress
+    if(cpm->output_len>0 && cpm->output[cpm->output_len-1]=='\n'){
+        flush_output(cpm);
+    }
+}
+
+static void bdos_call(cpm_machine_t* cpm){
+    i8080* cpu=cpm->cpu;
+
+    switch(cpu->C){
+        case 2:         //Console output
+            output_bytes(cpm, &cpu->E, 1);
+            break;
+        case 9:{        //Print string
+            uint16_t addr=(cpu->D<<8)|cpu->E;
+            const uint8_t* end=memchr(&cpm->memory[addr], '$', CPM_MEM_SIZE-addr);
+            size_t len=end ? (size_t)(end-&cpm->memory[addr]) : (size_t)(CPM_MEM_SIZE-addr);
+
+            output_bytes(cpm, &cpm->memory[addr], len);
+            break;
+        }
+    }
+}
+
+void cpm_run(cpm_machine_t* cpm, uint64_t max_cycles){
+    i8080* cpu=cpm->cpu;
+
+    while(!cpm->finished && (max_cycles==0 || cpm->cycles<max_cycles)){
+        uint64_t instructions=0;
+
+        cpu->instruction_cycles=0;
+
+        while(cpu->instruction_cycles<CPM_BATCH_CYCLES){
+            //Both traps sit in the first page, so one compare covers them on the fast path
+            if(cpu->PC<=CPM_BDOS_ENTRY){
+                if(cpu->PC==0x0000){
+                    cpm->finished=1;
+                    break;
+                }
+                if(cpu->PC==CPM_BDOS_ENTRY){
+                    bdos_call(cpm);
+                }
+            }
+
+            uint8_t opcode=cpm->memory[cpu->PC];
+
+            if(opcode==0xD3 || opcode==0xDB){     //OUT/IN: no devices, IN reads 0xFF
+                if(opcode==0xDB){
+                    cpu->A=0xFF;
+                }
+                cpu->instruction_cycles+=10;
+                cpu->PC+=2;
+            }
+            else{
+                i8080_emulator(cpu);
+            }
+
+            instructions++;
+        }
+
+        cpm->cycles+=cpu->instruction_cycles;
+        cpm->instructions+=instructions;
+    }
+
+    flush_output(cpm);
+}
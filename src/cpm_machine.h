@@ -0,0 +1,43 @@
+#ifndef cpm_machine_H
+#define cpm_machine_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "i8080_cpu.h"
+
+#define CPM_MEM_SIZE		0x10000
+#define CPM_TPA_START		0x0100		//.COM programs are loaded and started here
+#define CPM_BDOS_ENTRY		0x0005
+#define CPM_BDOS_STUB		0xFE00		//Top of the TPA, holds a RET
+#define CPM_OUTPUT_SIZE		4096
+
+/*Minimal CP/M environment for running 8080 test and exerciser programs. Only the
+console output BDOS calls are provided:
+    C=2  print the character in E
+    C=9  print the '$'-terminated string at DE
+Jumping to 0x0000 (warm boot) ends the program*/
+typedef struct{
+    i8080* cpu;
+    uint8_t* memory;
+
+    FILE* console;
+    char output[CPM_OUTPUT_SIZE];      //Console output, written out per line
+    size_t output_len;
+
+    uint64_t cycles;
+    uint64_t instructions;
+    int finished;
+} cpm_machine_t;
+
+cpm_machine_t* cpm_init(FILE* console);
+
+void cpm_destroy(cpm_machine_t* cpm);
+
+//Loads a .COM program at 0x0100. Returns 0, or -1 after printing why it failed
+int cpm_load_com(cpm_machine_t* cpm, const char* path);
+
+//Runs until the program warm boots or max_cycles is reached (0 = no limit)
+void cpm_run(cpm_machine_t* cpm, uint64_t max_cycles);
+
+#endif
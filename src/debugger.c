@@ -0,0 +1,357 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "debugger.h"
+#include "disassembler.h"
+#include "i8080_opcodes.h"
+
+static inline int bitmap_test(const uint64_t* bitmap, uint16_t addr){
+    return (bitmap[addr>>6]>>(addr & 63)) & 1;
+}
+
+//Sets or clears a bit, returns 1 if it changed
+static inline int bitmap_set(uint64_t* bitmap, uint16_t addr, int enable){
+    uint64_t mask=(uint64_t)1<<(addr & 63);
+    int was_set=(bitmap[addr>>6] & mask)!=0;
+
+    if(enable){
+        bitmap[addr>>6]|=mask;
+    }
+    else{
+        bitmap[addr>>6]&=~mask;
+    }
+
+    return was_set!=(enable!=0);
+}
+
+static void update_armed(debugger_t* dbg){
+    dbg->armed=dbg->num_breakpoints>0 || dbg->num_watchpoints>0 || dbg->mode!=DEBUG_RUNNING;
+}
+
+debugger_t* debugger_init(uint32_t mem_size){
+    debugger_t* dbg=calloc(1, sizeof(debugger_t));
+
+    dbg->mode=DEBUG_RUNNING;
+    dbg->mem_size=mem_size;
+    dbg->gdb_listen_fd=-1;
+    dbg->gdb_fd=-1;
+
+    return dbg;
+}
+
+void debugger_destroy(debugger_t* dbg){
+    gdb_stub_close(dbg);
+    free(dbg);
+}
+
+void debugger_set_breakpoint(debugger_t* dbg, uint16_t addr, int enable){
+    if(bitmap_set(dbg->breakpoints, addr, enable)){
+        dbg->num_breakpoints+=enable ? 1 : -1;
+    }
+
+    update_armed(dbg);
+}
+
+void debugger_set_watchpoint(debugger_t* dbg, uint16_t addr, int len, int type, int enable){
+    for(int i=0; i<len; i++){
+        uint16_t a=addr+i;
+
+        if((type & WATCH_READ) && bitmap_set(dbg->watch_read, a, enable)){
+            dbg->num_watchpoints+=enable ? 1 : -1;
+        }
+        if((type & WATCH_WRITE) && bitmap_set(dbg->watch_write, a, enable)){
+            dbg->num_watchpoints+=enable ? 1 : -1;
+        }
+    }
+
+    update_armed(dbg);
+}
+
+void debugger_request_stop(debugger_t* dbg){
+    dbg->mode=DEBUG_BREAK_REQUESTED;
+    dbg->resumed=0;
+    update_armed(dbg);
+}
+
+void debugger_resume(debugger_t* dbg, i8080* cpu, int mode){
+    uint8_t opcode=read_mem(cpu, cpu->PC);
+    const i8080_opcode_t* info=&i8080_opcodes[opcode];
+
+    //Stepping over anything that isn't a call is a single step
+    if(mode==DEBUG_STEP_OVER && info->flow!=FLOW_CALL && info->flow!=FLOW_RST){
+        mode=DEBUG_STEP;
+    }
+
+    dbg->mode=mode;
+    dbg->step_pc=cpu->PC+info->length;
+    dbg->step_sp=cpu->SP;
+    dbg->pending_ret=0;
+    dbg->resumed=1;
+    dbg->stop_reason=STOP_NONE;
+
+    update_armed(dbg);
+}
+
+/*Works out which memory the instruction at PC is about to access. Conditional calls
+and returns are reported whether or not they are taken*/
+static int instruction_accesses(i8080* cpu, uint16_t* addr, uint8_t* len, uint8_t* type){
+    //PC can be anywhere (GDB sets it freely), so the bytes go through the address mask
+    uint8_t op[3]={read_mem(cpu, cpu->PC), read_mem(cpu, cpu->PC+1), read_mem(cpu, cpu->PC+2)};
+    uint16_t HL=(cpu->H<<8)|cpu->L;
+    uint16_t a16=(op[2]<<8)|op[1];
+    const i8080_opcode_t* info=&i8080_opcodes[op[0]];
+
+    switch(op[0]){
+        case 0x02: addr[0]=(cpu->B<<8)|cpu->C; len[0]=1; type[0]=WATCH_WRITE; return 1;   //STAX B
+        case 0x12: addr[0]=(cpu->D<<8)|cpu->E; len[0]=1; type[0]=WATCH_WRITE; return 1;   //STAX D
+        case 0x0A: addr[0]=(cpu->B<<8)|cpu->C; len[0]=1; type[0]=WATCH_READ; return 1;    //LDAX B
+        case 0x1A: addr[0]=(cpu->D<<8)|cpu->E; len[0]=1; type[0]=WATCH_READ; return 1;    //LDAX D
+        case 0x22: addr[0]=a16; len[0]=2; type[0]=WATCH_WRITE; return 1;                  //SHLD
+        case 0x2A: addr[0]=a16; len[0]=2; type[0]=WATCH_READ; return 1;                   //LHLD
+        case 0x32: addr[0]=a16; len[0]=1; type[0]=WATCH_WRITE; return 1;                  //STA
+        case 0x3A: addr[0]=a16; len[0]=1; type[0]=WATCH_READ; return 1;                   //LDA
+        case 0x34:      //INR M
+        case 0x35:      //DCR M
+            addr[0]=HL; len[0]=1; type[0]=WATCH_ACCESS;
+            return 1;
+        case 0x36: addr[0]=HL; len[0]=1; type[0]=WATCH_WRITE; return 1;                   //MVI M
+        case 0xE3: addr[0]=cpu->SP; len[0]=2; type[0]=WATCH_ACCESS; return 1;             //XTHL
+        case 0xC1: case 0xD1: case 0xE1: case 0xF1:     //POP
+            addr[0]=cpu->SP; len[0]=2; type[0]=WATCH_READ;
+            return 1;
+        case 0xC5: case 0xD5: case 0xE5: case 0xF5:     //PUSH
+            addr[0]=cpu->SP-2; len[0]=2; type[0]=WATCH_WRITE;
+            return 1;
+    }
+
+    if(op[0]>=0x70 && op[0]<=0x77 && op[0]!=0x76){      //MOV M, r
+        addr[0]=HL; len[0]=1; type[0]=WATCH_WRITE;
+        return 1;
+    }
+
+    //MOV r, M and the ALU operations on M
+    if((op[0]>=0x40 && op[0]<=0xBF && (op[0] & 0x07)==0x06 && op[0]!=0x76)){
+        addr[0]=HL; len[0]=1; type[0]=WATCH_READ;
+        return 1;
+    }
+
+    switch(info->flow){
+        case FLOW_CALL:
+        case FLOW_RST:
+            addr[0]=cpu->SP-2; len[0]=2; type[0]=WATCH_WRITE;
+            return 1;
+        case FLOW_RET:
+        case FLOW_RET_COND:
+            addr[0]=cpu->SP; len[0]=2; type[0]=WATCH_READ;
+            return 1;
+    }
+
+    return 0;
+}
+
+//Returns the stop reason if the instruction at PC touches a watched address
+static int check_watchpoints(debugger_t* dbg, i8080* cpu){
+    uint16_t addr[2];
+    uint8_t len[2], type[2];
+    int count=instruction_accesses(cpu, addr, len, type);
+
+    for(int i=0; i<count; i++){
+        for(int j=0; j<len[i]; j++){
+            uint16_t a=addr[i]+j;
+
+            if((type[i] & WATCH_WRITE) && bitmap_test(dbg->watch_write, a)){
+                dbg->stop_addr=a;
+                return STOP_WATCH_WRITE;
+            }
+            if((type[i] & WATCH_READ) && bitmap_test(dbg->watch_read, a)){
+                dbg->stop_addr=a;
+                return STOP_WATCH_READ;
+            }
+        }
+    }
+
+    return STOP_NONE;
+}
+
+int debugger_check(debugger_t* dbg, i8080* cpu){
+    int first=dbg->resumed;
+    int reason=STOP_NONE;
+
+    dbg->resumed=0;
+
+    switch(dbg->mode){
+        case DEBUG_BREAK_REQUESTED:
+            reason=STOP_USER;
+            break;
+        case DEBUG_STEP:
+            if(!first){
+                reason=STOP_STEP;
+            }
+            break;
+        case DEBUG_STEP_OVER:
+            if(!first && cpu->PC==dbg->step_pc && cpu->SP>=dbg->step_sp){
+                reason=STOP_STEP;
+            }
+            break;
+        case DEBUG_STEP_OUT:
+            if(dbg->pending_ret && cpu->SP>dbg->step_sp){
+                reason=STOP_STEP;
+            }
+            dbg->pending_ret=i8080_opcodes[read_mem(cpu, cpu->PC)].flow==FLOW_RET ||
+                             i8080_opcodes[read_mem(cpu, cpu->PC)].flow==FLOW_RET_COND;
+            break;
+    }
+
+    if(reason==STOP_NONE && !first){
+        if(dbg->num_breakpoints>0 && bitmap_test(dbg->breakpoints, cpu->PC)){
+            reason=STOP_BREAKPOINT;
+        }
+        else if(dbg->num_watchpoints>0){
+            reason=check_watchpoints(dbg, cpu);
+        }
+    }
+
+    if(reason!=STOP_NONE){
+        dbg->stop_reason=reason;
+        dbg->mode=DEBUG_RUNNING;
+        update_armed(dbg);
+        return 1;
+    }
+
+    return 0;
+}
+
+void debugger_print_state(debugger_t* dbg, i8080* cpu){
+    static const char* reasons[]={"", "breakpoint", "read watchpoint", "write watchpoint", "step", "interrupted"};
+    char text[32];
+
+    uint8_t bytes[3]={read_mem(cpu, cpu->PC), read_mem(cpu, cpu->PC+1), read_mem(cpu, cpu->PC+2)};
+
+    i8080_disasm(text, sizeof(text), bytes, sizeof(bytes), 0);
+
+    if(dbg->stop_reason==STOP_WATCH_READ || dbg->stop_reason==STOP_WATCH_WRITE){
+        printf("Stopped (%s on $%04x)\n", reasons[dbg->stop_reason], dbg->stop_addr);
+    }
+    else{
+        printf("Stopped (%s)\n", reasons[dbg->stop_reason]);
+    }
+
+    print_values(cpu);
+    printf("\tPC=$%04x  %s\n", cpu->PC, text);
+}
+
+//Reads memory the way the debugger sees it: addresses outside the CPU's memory read as 0
+static uint8_t peek(debugger_t* dbg, i8080* cpu, uint16_t addr){
+    return (addr<dbg->mem_size) ? cpu->memory[addr] : 0;
+}
+
+static void console_help(){
+    printf("  c                continue\n"
+           "  s                step one instruction\n"
+           "  n                step over CALL/RST\n"
+           "  f                step out of the current routine\n"
+           "  b addr / bd addr set / delete a breakpoint\n"
+           "  w addr [r|w|rw]  set a watchpoint (default w)\n"
+           "  wd addr          delete a watchpoint\n"
+           "  r                show registers\n"
+           "  x addr [count]   dump memory\n"
+           "  d [addr] [count] disassemble\n"
+           "  q                quit the emulator\n");
+}
+
+//Interactive console on stdin, returns when execution is resumed
+static void console_stopped(debugger_t* dbg, i8080* cpu){
+    char line[128];
+
+    debugger_print_state(dbg, cpu);
+
+    while(1){
+        printf("(i8080) ");
+        fflush(stdout);
+
+        if(!fgets(line, sizeof(line), stdin)){
+            dbg->quit=1;
+            return;
+        }
+
+        char cmd[8]="";
+        char arg3[8]="";
+        unsigned int arg1=0, arg2=0;
+        int num_args=sscanf(line, "%7s %x %7s", cmd, &arg1, arg3);
+        sscanf(arg3, "%x", &arg2);
+
+        if(strcmp(cmd, "c")==0){
+            debugger_resume(dbg, cpu, DEBUG_RUNNING);
+            return;
+        }
+        else if(strcmp(cmd, "s")==0){
+            debugger_resume(dbg, cpu, DEBUG_STEP);
+            return;
+        }
+        else if(strcmp(cmd, "n")==0){
+            debugger_resume(dbg, cpu, DEBUG_STEP_OVER);
+            return;
+        }
+        else if(strcmp(cmd, "f")==0){
+            debugger_resume(dbg, cpu, DEBUG_STEP_OUT);
+            return;
+        }
+        else if(strcmp(cmd, "q")==0){
+            dbg->quit=1;
+            return;
+        }
+        else if((strcmp(cmd, "b")==0 || strcmp(cmd, "bd")==0) && num_args>=2){
+            debugger_set_breakpoint(dbg, arg1, cmd[1]!='d');
+        }
+        else if(strcmp(cmd, "w")==0 && num_args>=2){
+            int type=WATCH_WRITE;
+            if(strcmp(arg3, "r")==0) type=WATCH_READ;
+            if(strcmp(arg3, "rw")==0) type=WATCH_ACCESS;
+            debugger_set_watchpoint(dbg, arg1, 1, type, 1);
+        }
+        else if(strcmp(cmd, "wd")==0 && num_args>=2){
+            debugger_set_watchpoint(dbg, arg1, 1, WATCH_ACCESS, 0);
+        }
+        else if(strcmp(cmd, "r")==0){
+            debugger_print_state(dbg, cpu);
+        }
+        else if(strcmp(cmd, "x")==0 && num_args>=2){
+            int count=(num_args>=3) ? arg2 : 64;
+            for(int i=0; i<count; i++){
+                if(i % 16==0) printf("%s%04x:", i ? "\n" : "", (uint16_t)(arg1+i));
+                printf(" %02x", peek(dbg, cpu, arg1+i));
+            }
+            printf("\n");
+        }
+        else if(strcmp(cmd, "d")==0){
+            uint16_t addr=(num_args>=2) ? arg1 : cpu->PC;
+            int count=(num_args>=3) ? arg2 : 10;
+            char text[32];
+
+            for(int i=0; i<count && addr<dbg->mem_size; i++){
+                int length=i8080_disasm(text, sizeof(text), cpu->memory, dbg->mem_size, addr);
+                printf("%c %04x  %s\n", bitmap_test(dbg->breakpoints, addr) ? '*' : ' ', addr, text);
+                addr+=length;
+            }
+        }
+        else if(cmd[0]){
+            console_help();
+        }
+    }
+}
+
+void debugger_stopped(debugger_t* dbg, i8080* cpu){
+    if(dbg->gdb_fd>=0){
+        gdb_stub_stopped(dbg, cpu);
+    }
+    else{
+        console_stopped(dbg, cpu);
+    }
+}
+
+void debugger_poll(debugger_t* dbg){
+    if(dbg->gdb_fd>=0){
+        gdb_stub_poll(dbg);
+    }
+}
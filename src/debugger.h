@@ -0,0 +1,90 @@
+#ifndef debugger_H
+#define debugger_H
+
+#include <stdint.h>
+
+#include "i8080_cpu.h"
+
+#define DEBUG_BITMAP_WORDS	(0x10000 / 64)		//One bit per address
+
+enum debug_mode{
+    DEBUG_RUNNING,
+    DEBUG_BREAK_REQUESTED,     //Stop before the next instruction
+    DEBUG_STEP,                //Stop after one instruction
+    DEBUG_STEP_OVER,           //Stop when the CALL/RST at step_pc returns
+    DEBUG_STEP_OUT             //Stop after the current routine returns
+};
+
+enum stop_reason{STOP_NONE, STOP_BREAKPOINT, STOP_WATCH_READ, STOP_WATCH_WRITE, STOP_STEP, STOP_USER};
+
+enum watch_type{WATCH_READ=1, WATCH_WRITE=2, WATCH_ACCESS=3};
+
+typedef struct{
+    uint64_t breakpoints[DEBUG_BITMAP_WORDS];
+    uint64_t watch_read[DEBUG_BITMAP_WORDS];
+    uint64_t watch_write[DEBUG_BITMAP_WORDS];
+    int num_breakpoints;
+    int num_watchpoints;
+
+    /*Non-zero when anything has to be checked before each instruction. The machine
+    only switches from its fast loop to the checked loop while this is set*/
+    int armed;
+
+    int mode;
+    uint16_t step_pc;
+    uint16_t step_sp;
+    int pending_ret;           //The previous instruction was a return (for step out)
+    int resumed;               //Don't stop again on the instruction we stopped at
+
+    int stop_reason;
+    uint16_t stop_addr;        //Watched address that triggered the stop
+
+    uint32_t mem_size;         //Size of the CPU's memory, accesses beyond it are ignored
+
+    //GDB remote stub (see gdb_stub.c), -1 when not in use
+    int gdb_listen_fd;
+    int gdb_fd;
+    int gdb_resumed;           //GDB resumed execution and expects a stop reply
+
+    int quit;                  //The user asked to quit from the debugger
+} debugger_t;
+
+debugger_t* debugger_init(uint32_t mem_size);
+
+void debugger_destroy(debugger_t* dbg);
+
+void debugger_set_breakpoint(debugger_t* dbg, uint16_t addr, int enable);
+
+void debugger_set_watchpoint(debugger_t* dbg, uint16_t addr, int len, int type, int enable);
+
+//Stops before the next instruction, e.g. on a hotkey or a GDB interrupt
+void debugger_request_stop(debugger_t* dbg);
+
+//Resumes execution in the given mode (DEBUG_RUNNING, DEBUG_STEP, ...)
+void debugger_resume(debugger_t* dbg, i8080* cpu, int mode);
+
+//Called before each instruction while armed, returns 1 if execution must stop
+int debugger_check(debugger_t* dbg, i8080* cpu);
+
+//Hands control to the GDB stub or the console until the user resumes
+void debugger_stopped(debugger_t* dbg, i8080* cpu);
+
+//Called once per frame while running, picks up GDB interrupt requests
+void debugger_poll(debugger_t* dbg);
+
+//Prints registers and the instruction at PC
+void debugger_print_state(debugger_t* dbg, i8080* cpu);
+
+//Listens on "port", "host:port" or "unix:path" and waits for GDB to attach.
+//Returns 0 on success, -1 on failure
+int gdb_stub_listen(debugger_t* dbg, const char* address);
+
+//Serves GDB packets until GDB resumes execution
+void gdb_stub_stopped(debugger_t* dbg, i8080* cpu);
+
+//Non-blocking check for a GDB interrupt (Ctrl-C) while running
+void gdb_stub_poll(debugger_t* dbg);
+
+void gdb_stub_close(debugger_t* dbg);
+
+#endif
@@ -1,8 +1,30 @@
 #ifndef disassembler_H
 #define disassembler_H
 
+#include <stdio.h>
+#include <stddef.h>
 #include <stdint.h>
 
+//Flags in the map produced by i8080_discover_code()
+#define DISASM_CODE		0x01	//First byte of an instruction
+#define DISASM_OPERAND		0x02	//Operand byte of an instruction
+#define DISASM_JUMP_TARGET	0x04	//Target of a jump
+#define DISASM_CALL_TARGET	0x08	//Target of a CALL or RST
+
+//Prints the instruction at pc of a 64K memory to stdout
 void i8080_disassembler(uint8_t *memory, int pc);
 
+/*Formats the instruction at pc of mem (mem_size bytes) into buf (at most len bytes
+including the terminating NUL) and returns the instruction length in bytes. Operand
+bytes past the end of mem are shown as 0. Reentrant, does no I/O*/
+int i8080_disasm(char* buf, size_t len, const uint8_t* mem, size_t mem_size, uint16_t pc);
+
+/*Follows JMP/CALL/RST and conditional branches from the entry points through a ROM
+image loaded at origin, and marks code bytes and branch targets in map (size bytes)*/
+void i8080_discover_code(const uint8_t* rom, int size, uint16_t origin,
+                         const uint16_t* entries, int num_entries, uint8_t* map);
+
+//Writes a labelled listing of the ROM: discovered code is disassembled, the rest is emitted as DB
+void i8080_write_listing(FILE* out, const uint8_t* rom, int size, uint16_t origin, const uint8_t* map);
+
 #endif
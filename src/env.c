@@ -0,0 +1,360 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "env.h"
+#include "rom.h"
+
+#define BOOT_MAX_FRAMES		2000		//Give up if the game has not started by then
+
+//Input port 1 bits for each action, bit 3 is always set
+static const uint8_t action_ports[ENV_NUM_ACTIONS]={
+    0x00,           //ENV_NOOP
+    0x10,           //ENV_FIRE
+    0x20,           //ENV_LEFT
+    0x40,           //ENV_RIGHT
+    0x30,           //ENV_LEFT_FIRE
+    0x50            //ENV_RIGHT_FIRE
+};
+
+/*Number of lit pixels in each pair of rows of a VRAM byte, times 63. Byte k of the
+result is rows 2k and 2k+1 counted from the top of the byte (bit 7)*/
+static uint32_t pair_counts[256];
+
+void env_default_config(env_config_t* config){
+    memset(config, 0, sizeof(env_config_t));
+
+    config->obs_type=ENV_OBS_DOWNSAMPLED;
+    config->frame_skip=4;
+    config->sticky_actions=0.25f;
+    config->noop_max=30;
+    config->max_frames=0;
+    config->num_threads=0;
+    config->seed=1;
+}
+
+static uint64_t splitmix64(uint64_t* state){
+    uint64_t z=(*state+=0x9E3779B97F4A7C15ULL);
+
+    z=(z^(z>>30)) * 0xBF58476D1CE4E5B9ULL;
+    z=(z^(z>>27)) * 0x94D049BB133111EBULL;
+
+    return z^(z>>31);
+}
+
+static int bcd_score(const uint8_t* mem){
+    uint8_t low=mem[ENV_P1_SCORE], high=mem[ENV_P1_SCORE+1];
+
+    return (high>>4)*1000 + (high & 0x0F)*100 + (low>>4)*10 + (low & 0x0F);
+}
+
+//Inserts a coin and presses start, leaving the machine on the first frame of the game
+static int boot_game(machine_t* machine){
+    int frame=0;
+
+    for(; frame<BOOT_MAX_FRAMES; frame++){
+        //Coin after the power-on self test, start once the credit has registered
+        machine->port_in1=(1<<3);
+        if(frame>=100 && frame<106){
+            machine->port_in1|=(1<<0);
+        }
+        else if(frame>=200 && machine->machine_mem[ENV_GAME_MODE]==0){
+            machine->port_in1|=(1<<2);
+        }
+
+        machine_run_frame(machine);
+
+        if(machine->machine_mem[ENV_GAME_MODE] && machine->machine_mem[ENV_P1_SHIPS]){
+            machine->port_in1=(1<<3);
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+static void write_obs(env_t* env, machine_t* machine, uint8_t* obs){
+    const uint8_t* vram=machine->machine_mem+VRAM_START;
+
+    if(env->config.obs_type==ENV_OBS_VRAM){
+        memcpy(obs, vram, VRAM_SIZE);
+        return;
+    }
+
+    /*Each VRAM row is a screen column with the bottom pixel first, so two rows make one
+    output column and each pair of bytes gives four output rows. Going across the
+    columns in the inner loop writes the output rows in order*/
+    for(int b=0; b<0x20; b++){
+        uint8_t* out=obs + (4*(0x1F-b))*ENV_OBS_WIDTH;
+
+        for(int x=0; x<ENV_OBS_WIDTH; x++){
+            const uint8_t* column=vram + (2*x)*0x20 + b;
+            uint32_t counts=pair_counts[column[0]] + pair_counts[column[0x20]];
+
+            out[x]=counts;
+            out[ENV_OBS_WIDTH+x]=counts>>8;
+            out[2*ENV_OBS_WIDTH+x]=counts>>16;
+            out[3*ENV_OBS_WIDTH+x]=counts>>24;
+        }
+    }
+}
+
+static void reset_instance(env_t* env, env_instance_t* instance){
+    machine_t* machine=instance->machine;
+
+    machine_copy_state(machine, env->start);
+
+    instance->last_action=ENV_NOOP;
+    instance->score=0;
+    instance->ships=machine->machine_mem[ENV_P1_SHIPS];
+    instance->frames=0;
+    instance->needs_reset=0;
+
+    int noops=env->config.noop_max>0 ? splitmix64(&instance->rng) % (env->config.noop_max+1) : 0;
+    for(int i=0; i<noops; i++){
+        machine_run_frame(machine);
+        instance->frames++;
+    }
+}
+
+static void step_instance(env_t* env, int index){
+    env_instance_t* instance=&env->instances[index];
+    machine_t* machine=instance->machine;
+    uint8_t* obs=env->obs + (size_t)index*env->obs_size;
+    float reward=0;
+    int done=0;
+
+    if(instance->needs_reset){
+        reset_instance(env, instance);
+    }
+    else{
+        int action=env->actions[index];
+        if(action<0 || action>=ENV_NUM_ACTIONS){
+            action=ENV_NOOP;
+        }
+
+        for(int i=0; i<env->config.frame_skip && !done; i++){
+            //Sticky actions: the new action only takes effect with probability 1-sticky_actions
+            float chance=(splitmix64(&instance->rng)>>40) * (1.0f / (1<<24));
+            if(chance>=env->config.sticky_actions){
+                instance->last_action=action;
+            }
+
+            machine->port_in1=(1<<3) | action_ports[instance->last_action];
+            machine_run_frame(machine);
+            instance->frames++;
+
+            //The 4-digit score wraps at 9999
+            int score=bcd_score(machine->machine_mem);
+            reward+=(score>=instance->score) ? score-instance->score : score+10000-instance->score;
+            instance->score=score;
+
+            //Bonus ships raise the count, only losses are rewarded
+            int ships=machine->machine_mem[ENV_P1_SHIPS];
+            int lost=ships<instance->ships;
+            if(lost){
+                reward+=(instance->ships-ships) * env->config.life_loss_reward;
+            }
+            instance->ships=ships;
+
+            done=machine->machine_mem[ENV_GAME_MODE]==0 ||
+                 (lost && env->config.done_on_life_loss) ||
+                 (env->config.max_frames && instance->frames>=env->config.max_frames);
+        }
+
+        instance->needs_reset=done;
+    }
+
+    write_obs(env, machine, obs);
+
+    if(env->rewards){
+        env->rewards[index]=reward;
+    }
+    if(env->dones){
+        env->dones[index]=done;
+    }
+}
+
+//Steps this worker's share of the environments
+static void step_range(env_t* env, int id){
+    int first=(int)((int64_t)env->num_envs * id / env->num_threads);
+    int last=(int)((int64_t)env->num_envs * (id+1) / env->num_threads);
+
+    for(int i=first; i<last; i++){
+        step_instance(env, i);
+    }
+}
+
+static void* env_worker(void* arg){
+    env_worker_t* worker=arg;
+    env_t* env=worker->env;
+    uint64_t seen=0;
+
+    pthread_mutex_lock(&env->lock);
+
+    while(1){
+        while(env->generation==seen && !env->stop){
+            pthread_cond_wait(&env->start_cond, &env->lock);
+        }
+
+        if(env->stop){
+            break;
+        }
+
+        seen=env->generation;
+        pthread_mutex_unlock(&env->lock);
+
+        step_range(env, worker->id);
+
+        pthread_mutex_lock(&env->lock);
+        if(--env->busy==0){
+            pthread_cond_signal(&env->done_cond);
+        }
+    }
+
+    pthread_mutex_unlock(&env->lock);
+
+    return NULL;
+}
+
+//Runs step_instance() on every environment, the caller takes the first share
+static void step_all(env_t* env){
+    if(env->num_threads>1){
+        pthread_mutex_lock(&env->lock);
+        env->busy=env->num_threads-1;
+        env->generation++;
+        pthread_cond_broadcast(&env->start_cond);
+        pthread_mutex_unlock(&env->lock);
+    }
+
+    step_range(env, 0);
+
+    if(env->num_threads>1){
+        pthread_mutex_lock(&env->lock);
+        while(env->busy){
+            pthread_cond_wait(&env->done_cond, &env->lock);
+        }
+        pthread_mutex_unlock(&env->lock);
+    }
+}
+
+env_t* env_create(int num_envs, const env_config_t* config){
+    char rom_path[ROM_PATH_MAX]="";
+
+#ifndef EMBED_ROMS
+    if(rom_find_dir(config->rom_dir, rom_path, sizeof(rom_path))<0){
+        printf("Cannot find the ROM directory\n");
+        return NULL;
+    }
+#endif
+
+    machine_t* start=init_machine();
+
+    if(load_game(start, rom_path)<0){
+        destroy_machine(start);
+        return NULL;
+    }
+
+    if(boot_game(start)<0){
+        printf("The game did not start within %d frames\n", BOOT_MAX_FRAMES);
+        destroy_machine(start);
+        return NULL;
+    }
+
+    for(int v=0; v<256; v++){
+        uint32_t counts=0;
+
+        for(int k=0; k<4; k++){
+            int pair=(v>>(6-2*k)) & 3;
+            counts|=(uint32_t)(((pair>>1) + (pair & 1)) * 63) << (8*k);
+        }
+
+        pair_counts[v]=counts;
+    }
+
+    env_t* env=calloc(1, sizeof(env_t));
+
+    env->num_envs=num_envs;
+    env->config=*config;
+    env->obs_size=(config->obs_type==ENV_OBS_VRAM) ? VRAM_SIZE : ENV_OBS_WIDTH * ENV_OBS_HEIGHT;
+    env->start=start;
+
+    if(env->config.frame_skip<1){
+        env->config.frame_skip=1;
+    }
+
+    env->instances=calloc(num_envs, sizeof(env_instance_t));
+    for(int i=0; i<num_envs; i++){
+        env->instances[i].machine=init_machine();
+        env->instances[i].rng=config->seed + (uint64_t)i * 0x9E3779B97F4A7C15ULL;
+        env->instances[i].needs_reset=1;
+    }
+
+    env->num_threads=config->num_threads>0 ? config->num_threads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if(env->num_threads>num_envs){
+        env->num_threads=num_envs;
+    }
+    if(env->num_threads<1){
+        env->num_threads=1;
+    }
+
+    pthread_mutex_init(&env->lock, NULL);
+    pthread_cond_init(&env->start_cond, NULL);
+    pthread_cond_init(&env->done_cond, NULL);
+
+    env->workers=calloc(env->num_threads, sizeof(env_worker_t));
+    for(int i=1; i<env->num_threads; i++){
+        env->workers[i].env=env;
+        env->workers[i].id=i;
+        pthread_create(&env->workers[i].thread, NULL, env_worker, &env->workers[i]);
+    }
+
+    return env;
+}
+
+void env_destroy(env_t* env){
+    pthread_mutex_lock(&env->lock);
+    env->stop=1;
+    pthread_cond_broadcast(&env->start_cond);
+    pthread_mutex_unlock(&env->lock);
+
+    for(int i=1; i<env->num_threads; i++){
+        pthread_join(env->workers[i].thread, NULL);
+    }
+
+    pthread_mutex_destroy(&env->lock);
+    pthread_cond_destroy(&env->start_cond);
+    pthread_cond_destroy(&env->done_cond);
+
+    for(int i=0; i<env->num_envs; i++){
+        destroy_machine(env->instances[i].machine);
+    }
+
+    destroy_machine(env->start);
+    free(env->instances);
+    free(env->workers);
+    free(env);
+}
+
+void env_reset(env_t* env, uint8_t* obs_out){
+    for(int i=0; i<env->num_envs; i++){
+        env->instances[i].needs_reset=1;
+    }
+
+    env->actions=NULL;
+    env->obs=obs_out;
+    env->rewards=NULL;
+    env->dones=NULL;
+
+    step_all(env);
+}
+
+void env_step(env_t* env, const int* actions, uint8_t* obs_out, float* reward_out, uint8_t* done_out){
+    env->actions=actions;
+    env->obs=obs_out;
+    env->rewards=reward_out;
+    env->dones=done_out;
+
+    step_all(env);
+}
@@ -0,0 +1,98 @@
+#ifndef env_H
+#define env_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include "machine.h"
+
+//Actions an agent can take, the same set the cabinet's controls allow during play
+enum env_actions{ENV_NOOP, ENV_FIRE, ENV_LEFT, ENV_RIGHT, ENV_LEFT_FIRE, ENV_RIGHT_FIRE, ENV_NUM_ACTIONS};
+
+#define ENV_OBS_VRAM		0		//VRAM_SIZE bytes of 1bpp VRAM, laid out as the machine stores it
+#define ENV_OBS_DOWNSAMPLED	1		//ENV_OBS_HEIGHT rows of ENV_OBS_WIDTH bytes, upright
+
+//A downsampled pixel is the number of lit pixels in a 2x2 block times 63 (0-252)
+#define ENV_OBS_WIDTH		(SCREEN_WIDTH / 2)
+#define ENV_OBS_HEIGHT		(SCREEN_HEIGHT / 2)
+
+//RAM locations of the game state (see computerarcheology.com)
+#define ENV_GAME_MODE		0x20EF		//1 while a game is being played
+#define ENV_P1_SCORE		0x20F8		//BCD, low byte first
+#define ENV_P1_SHIPS		0x21FF		//Ships left in reserve
+
+typedef struct{
+    const char* rom_dir;	//NULL searches the usual places, see rom_find_dir()
+    int obs_type;
+    int frame_skip;		//Emulated frames per step, the action is held for all of them
+    float sticky_actions;	//Chance that a frame repeats the previous action instead
+    int noop_max;		//Episodes start after 0-noop_max random idle frames
+    int max_frames;		//Episodes are cut off after this many frames, 0 = never
+    float life_loss_reward;	//Added to the reward for every ship lost, e.g. -100 (default 0)
+    int done_on_life_loss;	//End the episode when a ship is lost rather than at game over
+    int num_threads;		//Worker threads including the caller, 0 = one per online CPU
+    uint64_t seed;
+} env_config_t;
+
+//One machine and its episode
+typedef struct{
+    machine_t* machine;
+    uint64_t rng;
+    int last_action;
+    int score;
+    int ships;			//Ships in reserve after the last frame
+    int frames;
+    int needs_reset;
+} env_instance_t;
+
+struct env;
+
+typedef struct{
+    struct env* env;
+    int id;			//Worker 0 is the thread calling env_step()
+    pthread_t thread;
+} env_worker_t;
+
+typedef struct env{
+    int num_envs;
+    env_config_t config;
+    int obs_size;		//Bytes per observation
+
+    machine_t* start;		//State at the start of a game, every episode is restored from it
+    env_instance_t* instances;
+
+    //Arguments of the current env_step(), shared with the workers
+    const int* actions;
+    uint8_t* obs;
+    float* rewards;
+    uint8_t* dones;
+
+    int num_threads;
+    env_worker_t* workers;
+    pthread_mutex_t lock;
+    pthread_cond_t start_cond, done_cond;
+    uint64_t generation;	//Bumped for each batch handed to the workers
+    int busy;			//Workers still working on the current batch
+    int stop;
+} env_t;
+
+void env_default_config(env_config_t* config);
+
+//Boots the game once and creates num_envs machines. Prints what is wrong and returns
+//NULL if the ROM set cannot be loaded
+env_t* env_create(int num_envs, const env_config_t* config);
+
+void env_destroy(env_t* env);
+
+//Starts a new episode in every environment and writes the first observations,
+//obs_out holds num_envs * env->obs_size bytes
+void env_reset(env_t* env, uint8_t* obs_out);
+
+/*Steps every environment by frame_skip frames in parallel. actions holds one of
+enum env_actions per environment. Rewards are the points scored during the step,
+plus life_loss_reward for each ship lost. done is set when the game is over, a ship
+is lost with done_on_life_loss or max_frames is reached; that environment starts a
+new episode at its next step, ignoring the action*/
+void env_step(env_t* env, const int* actions, uint8_t* obs_out, float* reward_out, uint8_t* done_out);
+
+#endif
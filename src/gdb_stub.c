@@ -0,0 +1,439 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "debugger.h"
+
+/*GDB remote serial protocol stub. GDB has no 8080 target, but the 8080 is a subset of
+the Z80, so the register file is reported in GDB's z80 layout ("set architecture z80"):
+AF BC DE HL SP PC IX IY AF' BC' DE' HL' IR, 16 bits each, little endian. Registers
+that don't exist on the 8080 read as 0*/
+
+#define GDB_PACKET_SIZE		4096
+#define GDB_NUM_REGS		13
+
+static const char hex_digits[]="0123456789abcdef";
+
+static int hex_value(char c){
+    if(c>='0' && c<='9') return c-'0';
+    if(c>='a' && c<='f') return c-'a'+10;
+    if(c>='A' && c<='F') return c-'A'+10;
+    return -1;
+}
+
+//Reads one byte from GDB, returns -1 if the connection is closed
+static int read_byte(debugger_t* dbg){
+    uint8_t c;
+
+    if(recv(dbg->gdb_fd, &c, 1, 0)!=1){
+        return -1;
+    }
+
+    return c;
+}
+
+static void send_raw(debugger_t* dbg, const char* data, size_t len){
+    while(len>0){
+        ssize_t n=send(dbg->gdb_fd, data, len, 0);
+        if(n<=0){
+            return;
+        }
+        data+=n;
+        len-=n;
+    }
+}
+
+static void send_packet(debugger_t* dbg, const char* data){
+    char packet[GDB_PACKET_SIZE+4];
+    uint8_t checksum=0;
+    size_t len=0;
+
+    packet[len++]='$';
+    for(const char* p=data; *p && len<GDB_PACKET_SIZE; p++){
+        packet[len++]=*p;
+        checksum+=*p;
+    }
+    packet[len++]='#';
+    packet[len++]=hex_digits[checksum>>4];
+    packet[len++]=hex_digits[checksum & 0x0F];
+
+    send_raw(dbg, packet, len);
+}
+
+/*Receives a packet body into buf. Returns its length, -2 for an interrupt (Ctrl-C)
+or -1 if the connection is closed*/
+static int receive_packet(debugger_t* dbg, char* buf, int size){
+    int c;
+
+    while(1){
+        //Skip acknowledgements and noise until the start of a packet
+        do{
+            c=read_byte(dbg);
+            if(c==0x03){
+                return -2;
+            }
+        } while(c>=0 && c!='$');
+
+        if(c<0){
+            return -1;
+        }
+
+        int len=0;
+        uint8_t checksum=0;
+
+        while((c=read_byte(dbg))>=0 && c!='#'){
+            if(len<size-1){
+                buf[len++]=c;
+            }
+            checksum+=c;
+        }
+
+        int high=read_byte(dbg);
+        int low=read_byte(dbg);
+        if(c<0 || high<0 || low<0){
+            return -1;
+        }
+
+        if(((hex_value(high)<<4)|hex_value(low))==checksum){
+            send_raw(dbg, "+", 1);
+            buf[len]='\0';
+            return len;
+        }
+
+        send_raw(dbg, "-", 1);
+    }
+}
+
+static void send_stop_reply(debugger_t* dbg){
+    char reply[32];
+
+    switch(dbg->stop_reason){
+        case STOP_WATCH_WRITE: snprintf(reply, sizeof(reply), "T05watch:%04x;", dbg->stop_addr); break;
+        case STOP_WATCH_READ: snprintf(reply, sizeof(reply), "T05rwatch:%04x;", dbg->stop_addr); break;
+        case STOP_USER: snprintf(reply, sizeof(reply), "S02"); break;
+        default: snprintf(reply, sizeof(reply), "S05"); break;
+    }
+
+    send_packet(dbg, reply);
+}
+
+static void get_registers(i8080* cpu, uint16_t* regs){
+    memset(regs, 0, sizeof(uint16_t) * GDB_NUM_REGS);
+
+    regs[0]=(cpu->A<<8)|i8080_get_psw(cpu);
+    regs[1]=(cpu->B<<8)|cpu->C;
+    regs[2]=(cpu->D<<8)|cpu->E;
+    regs[3]=(cpu->H<<8)|cpu->L;
+    regs[4]=cpu->SP;
+    regs[5]=cpu->PC;
+}
+
+static void set_register(i8080* cpu, int num, uint16_t value){
+    switch(num){
+        case 0: cpu->A=value>>8; i8080_set_psw(cpu, value & 0xFF); break;
+        case 1: cpu->B=value>>8; cpu->C=value & 0xFF; break;
+        case 2: cpu->D=value>>8; cpu->E=value & 0xFF; break;
+        case 3: cpu->H=value>>8; cpu->L=value & 0xFF; break;
+        case 4: cpu->SP=value; break;
+        case 5: cpu->PC=value; break;
+    }
+}
+
+//Parses a little-endian 16-bit register value from 4 hex digits
+static uint16_t parse_reg(const char* hex){
+    return (hex_value(hex[0])<<4 | hex_value(hex[1])) | (hex_value(hex[2])<<4 | hex_value(hex[3]))<<8;
+}
+
+//Handles one packet. Returns 1 when execution should resume
+static int handle_packet(debugger_t* dbg, i8080* cpu, char* packet){
+    char reply[GDB_PACKET_SIZE];
+    unsigned int addr, len, type;
+
+    reply[0]='\0';
+
+    switch(packet[0]){
+        case '?':
+            send_stop_reply(dbg);
+            return 0;
+
+        case 'g':{
+            uint16_t regs[GDB_NUM_REGS];
+            get_registers(cpu, regs);
+
+            for(int i=0; i<GDB_NUM_REGS; i++){
+                sprintf(&reply[i * 4], "%02x%02x", regs[i] & 0xFF, regs[i]>>8);
+            }
+            break;
+        }
+
+        case 'G':
+            for(int i=0; i<GDB_NUM_REGS && strlen(packet+1)>=(size_t)(i+1) * 4; i++){
+                set_register(cpu, i, parse_reg(&packet[1+i * 4]));
+            }
+            strcpy(reply, "OK");
+            break;
+
+        case 'P':{
+            char* value=strchr(packet, '=');
+            if(value && strlen(value+1)>=4){
+                set_register(cpu, strtol(packet+1, NULL, 16), parse_reg(value+1));
+                strcpy(reply, "OK");
+            }
+            else{
+                strcpy(reply, "E01");
+            }
+            break;
+        }
+
+        case 'p':{
+            uint16_t regs[GDB_NUM_REGS];
+            unsigned int num=strtol(packet+1, NULL, 16);
+            get_registers(cpu, regs);
+
+            if(num<GDB_NUM_REGS){
+                sprintf(reply, "%02x%02x", regs[num] & 0xFF, regs[num]>>8);
+            }
+            else{
+                strcpy(reply, "E01");
+            }
+            break;
+        }
+
+        case 'm':
+            //len is checked before doubling it, a huge len would wrap around
+            if(sscanf(packet+1, "%x,%x", &addr, &len)==2 && len<=(sizeof(reply)-1) / 2){
+                for(unsigned int i=0; i<len; i++){
+                    uint16_t a=addr+i;
+                    uint8_t byte=(a<dbg->mem_size) ? cpu->memory[a] : 0;
+                    reply[i * 2]=hex_digits[byte>>4];
+                    reply[i * 2+1]=hex_digits[byte & 0x0F];
+                }
+                reply[len * 2]='\0';
+            }
+            else{
+                strcpy(reply, "E01");
+            }
+            break;
+
+        case 'M':{
+            char* data=strchr(packet, ':');
+            if(data && sscanf(packet+1, "%x,%x", &addr, &len)==2 && len<=strlen(data+1) / 2){
+                //Debugger writes go straight to memory, ROM included
+                for(unsigned int i=0; i<len; i++){
+                    uint16_t a=addr+i;
+                    if(a<dbg->mem_size){
+                        cpu->memory[a]=(hex_value(data[1+i * 2])<<4)|hex_value(data[2+i * 2]);
+                    }
+                }
+                strcpy(reply, "OK");
+            }
+            else{
+                strcpy(reply, "E01");
+            }
+            break;
+        }
+
+        case 'c':
+        case 's':
+            if(packet[1]){
+                cpu->PC=strtol(packet+1, NULL, 16);
+            }
+            debugger_resume(dbg, cpu, packet[0]=='c' ? DEBUG_RUNNING : DEBUG_STEP);
+            dbg->gdb_resumed=1;
+            return 1;
+
+        case 'Z':
+        case 'z':
+            if(sscanf(packet+1, "%u,%x,%x", &type, &addr, &len)==3 && type<=4){
+                int enable=packet[0]=='Z';
+
+                //A watchpoint covers at most the whole address space, more would only loop over it again
+                if(type>=2 && len>0x10000){
+                    strcpy(reply, "E01");
+                }
+                else if(type<=1){        //Software and hardware breakpoints are the same bitmap
+                    debugger_set_breakpoint(dbg, addr, enable);
+                    strcpy(reply, "OK");
+                }
+                else{
+                    int watch=(type==2) ? WATCH_WRITE : (type==3) ? WATCH_READ : WATCH_ACCESS;
+                    debugger_set_watchpoint(dbg, addr, len, watch, enable);
+                    strcpy(reply, "OK");
+                }
+            }
+            break;
+
+        case 'k':
+            dbg->quit=1;
+            return 1;
+
+        case 'D':
+            send_packet(dbg, "OK");
+            gdb_stub_close(dbg);
+            debugger_resume(dbg, cpu, DEBUG_RUNNING);
+            return 1;
+
+        case 'H':
+            strcpy(reply, "OK");
+            break;
+
+        case 'q':
+            if(strncmp(packet, "qSupported", 10)==0){
+                snprintf(reply, sizeof(reply), "PacketSize=%x", GDB_PACKET_SIZE-1);
+            }
+            else if(strcmp(packet, "qAttached")==0){
+                strcpy(reply, "1");
+            }
+            else if(strcmp(packet, "qC")==0){
+                strcpy(reply, "QC1");
+            }
+            else if(strcmp(packet, "qfThreadInfo")==0){
+                strcpy(reply, "m1");
+            }
+            else if(strcmp(packet, "qsThreadInfo")==0){
+                strcpy(reply, "l");
+            }
+            break;
+    }
+
+    //Unsupported packets get an empty reply
+    send_packet(dbg, reply);
+
+    return 0;
+}
+
+int gdb_stub_listen(debugger_t* dbg, const char* address){
+    int fd;
+
+    if(strncmp(address, "unix:", 5)==0){
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family=AF_UNIX;
+        strncpy(addr.sun_path, address+5, sizeof(addr.sun_path)-1);
+        unlink(addr.sun_path);
+
+        fd=socket(AF_UNIX, SOCK_STREAM, 0);
+        if(fd<0 || bind(fd, (struct sockaddr*)&addr, sizeof(addr))<0){
+            printf("Cannot bind GDB socket %s\n", addr.sun_path);
+            if(fd>=0) close(fd);
+            return -1;
+        }
+    }
+    else{
+        //"port" listens on localhost only, "host:port" on the given interface
+        char host[64]="127.0.0.1";
+        const char* port=strrchr(address, ':');
+
+        if(port){
+            snprintf(host, sizeof(host), "%.*s", (int)(port-address), address);
+            port++;
+        }
+        else{
+            port=address;
+        }
+
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family=AF_INET;
+        addr.sin_port=htons(atoi(port));
+
+        if(inet_pton(AF_INET, host, &addr.sin_addr)!=1){
+            printf("Invalid GDB address %s\n", address);
+            return -1;
+        }
+
+        int reuse=1;
+        fd=socket(AF_INET, SOCK_STREAM, 0);
+        if(fd<0){
+            printf("Cannot create GDB socket\n");
+            return -1;
+        }
+
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        if(bind(fd, (struct sockaddr*)&addr, sizeof(addr))<0){
+            printf("Cannot bind GDB socket %s\n", address);
+            close(fd);
+            return -1;
+        }
+    }
+
+    if(listen(fd, 1)<0){
+        close(fd);
+        return -1;
+    }
+
+    printf("Waiting for GDB on %s ...\n", address);
+    fflush(stdout);
+
+    dbg->gdb_listen_fd=fd;
+    dbg->gdb_fd=accept(fd, NULL, NULL);
+
+    if(dbg->gdb_fd<0){
+        return -1;
+    }
+
+    int nodelay=1;
+    setsockopt(dbg->gdb_fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+    printf("GDB attached\n");
+
+    //Start stopped so GDB can set breakpoints before anything runs
+    dbg->gdb_resumed=0;
+    debugger_request_stop(dbg);
+
+    return 0;
+}
+
+void gdb_stub_stopped(debugger_t* dbg, i8080* cpu){
+    static char packet[GDB_PACKET_SIZE];
+
+    if(dbg->gdb_resumed){
+        send_stop_reply(dbg);
+        dbg->gdb_resumed=0;
+    }
+
+    while(dbg->gdb_fd>=0){
+        int len=receive_packet(dbg, packet, sizeof(packet));
+
+        if(len==-1){            //GDB went away, keep running without it
+            gdb_stub_close(dbg);
+            debugger_resume(dbg, cpu, DEBUG_RUNNING);
+            return;
+        }
+
+        if(len>=0 && handle_packet(dbg, cpu, packet)){
+            return;
+        }
+    }
+}
+
+void gdb_stub_poll(debugger_t* dbg){
+    uint8_t c;
+    ssize_t n=recv(dbg->gdb_fd, &c, 1, MSG_DONTWAIT);
+
+    if(n==1 && c==0x03){
+        debugger_request_stop(dbg);
+    }
+    else if(n==0){
+        gdb_stub_close(dbg);
+    }
+}
+
+void gdb_stub_close(debugger_t* dbg){
+    if(dbg->gdb_fd>=0){
+        close(dbg->gdb_fd);
+        dbg->gdb_fd=-1;
+    }
+
+    if(dbg->gdb_listen_fd>=0){
+        close(dbg->gdb_listen_fd);
+        dbg->gdb_listen_fd=-1;
+    }
+}
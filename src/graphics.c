@@ -1,11 +1,16 @@
 #include "graphics.h"
 
-void init_SDL(display_t* display){
+void init_SDL(display_t* display, scaler_t* scaler){
     SDL_Init(SDL_INIT_EVERYTHING);
 
+    display->scaler=scaler;
+
+    int width=scaler ? scaler->width : WINDOW_WIDTH;
+    int height=scaler ? scaler->height : WINDOW_HEIGHT;
+
     display->window=SDL_CreateWindow("Space Invaders", SDL_WINDOWPOS_UNDEFINED,
-		                                 SDL_WINDOWPOS_UNDEFINED, WINDOW_WIDTH,
-		                                 WINDOW_HEIGHT, SDL_WINDOW_RESIZABLE);
+		                                 SDL_WINDOWPOS_UNDEFINED, width,
+		                                 height, SDL_WINDOW_RESIZABLE);
 
     if(!display->window){
         printf("Cannot create a window\n");
@@ -20,9 +25,18 @@ void init_SDL(display_t* display){
         exit(1);
     }
 
-    display->texture=SDL_CreateTexture(display->renderer, SDL_PIXELFORMAT_RGB24,
-		                  SDL_TEXTUREACCESS_STREAMING, SCREEN_WIDTH,
-		                  SCREEN_HEIGHT);
+    if(scaler){
+        //The image is already at window size, so a resized window should not blur it either
+        SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "nearest");
+        display->texture=SDL_CreateTexture(display->renderer, SDL_PIXELFORMAT_RGB888,
+		                      SDL_TEXTUREACCESS_STREAMING, scaler->width,
+		                      scaler->height);
+    }
+    else{
+        display->texture=SDL_CreateTexture(display->renderer, SDL_PIXELFORMAT_RGB24,
+		                      SDL_TEXTUREACCESS_STREAMING, SCREEN_WIDTH,
+		                      SCREEN_HEIGHT);
+    }
 
     if(!display->texture){
         printf("Cannot create texture\n");
@@ -35,13 +49,46 @@ void destroy_SDL(display_t* display){
     SDL_DestroyRenderer(display->renderer);
     SDL_DestroyWindow(display->window);
     SDL_Quit();
+
+    if(display->scaler){
+        scaler_destroy(display->scaler);
+    }
     free(display);
 }
 
 void render_graphics(display_t* display, machine_t* machine){
-    uint32_t pitch=sizeof(uint8_t) * 3 * SCREEN_WIDTH;
-    SDL_UpdateTexture(display->texture, NULL, &machine->screen_buffer, pitch);
+    if(display->scaler){
+        scaler_t* scaler=display->scaler;
+
+        scaler_run(scaler, machine->screen->pixels, 0, SCREEN_WIDTH);
+        SDL_UpdateTexture(display->texture, NULL, scaler->pixels, sizeof(uint32_t) * scaler->pitch);
+    }
+    else{
+        uint32_t pitch=sizeof(uint8_t) * 3 * SCREEN_WIDTH;
+        SDL_UpdateTexture(display->texture, NULL, machine->screen->pixels, pitch);
+    }
+
+    present_graphics(display);
+}
+
+void render_slice(display_t* display, machine_t* machine, int first_line, int last_line){
+    //Scanlines are screen columns, so a slice is a vertical strip of the texture
+    if(display->scaler){
+        scaler_t* scaler=display->scaler;
+        SDL_Rect strip={first_line * scaler->scale, 0, (last_line-first_line) * scaler->scale, scaler->height};
+
+        scaler_run(scaler, machine->screen->pixels, first_line, last_line);
+        SDL_UpdateTexture(display->texture, &strip, scaler->pixels + strip.x, sizeof(uint32_t) * scaler->pitch);
+    }
+    else{
+        SDL_Rect strip={first_line, 0, last_line-first_line, SCREEN_HEIGHT};
+
+        uint32_t pitch=sizeof(uint8_t) * 3 * SCREEN_WIDTH;
+        SDL_UpdateTexture(display->texture, &strip, &machine->screen->pixels[0][first_line], pitch);
+    }
+}
 
+void present_graphics(display_t* display){
     SDL_RenderClear(display->renderer);
     SDL_RenderCopy(display->renderer, display->texture, NULL, NULL);
     SDL_RenderPresent(display->renderer);
@@ -3,6 +3,7 @@
 
 #include <SDL2/SDL.h>
 #include "machine.h"
+#include "scaler.h"
 
 #define WINDOW_WIDTH 	SCREEN_WIDTH * 3
 #define WINDOW_HEIGHT	SCREEN_HEIGHT * 3
@@ -11,12 +12,21 @@ typedef struct{
     SDL_Window* window;
     SDL_Renderer* renderer;
     SDL_Texture* texture;
+    scaler_t* scaler;		//CPU-side scaler, NULL leaves scaling to SDL_RenderCopy()
 } display_t;
 
-void init_SDL(display_t* display);
+//With a scaler the texture holds the scaled image and the window is sized to fit it.
+//The display takes ownership of the scaler
+void init_SDL(display_t* display, scaler_t* scaler);
 
 void destroy_SDL(display_t* display);
 
 void render_graphics(display_t* display, machine_t* machine);
 
+//Uploads scanlines [first_line, last_line) of the screen buffer to the display texture
+void render_slice(display_t* display, machine_t* machine, int first_line, int last_line);
+
+//Presents the display texture on the window
+void present_graphics(display_t* display);
+
 #endif
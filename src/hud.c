@@ -0,0 +1,191 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hud.h"
+
+#define HUD_GLYPH_WIDTH		4		//3 pixel glyphs plus a column of spacing
+#define HUD_LINE_HEIGHT		7
+#define HUD_GRAPH_HEIGHT	36
+#define HUD_US_PER_PIXEL	500		//Graph scale, so the 16.7 ms budget is about half way up
+#define HUD_MARGIN		2
+#define HUD_HEIGHT		(HUD_MARGIN + 2*HUD_LINE_HEIGHT + HUD_GRAPH_HEIGHT + HUD_MARGIN)
+
+//3x5 glyphs, one octal digit per row from the top, bit 2 is the left column
+#define GLYPH(r0, r1, r2, r3, r4)	(((r0)<<12) | ((r1)<<9) | ((r2)<<6) | ((r3)<<3) | (r4))
+
+static const uint16_t font[128]={
+    ['0']=GLYPH(07,05,05,05,07), ['1']=GLYPH(02,06,02,02,07), ['2']=GLYPH(07,01,07,04,07),
+    ['3']=GLYPH(07,01,07,01,07), ['4']=GLYPH(05,05,07,01,01), ['5']=GLYPH(07,04,07,01,07),
+    ['6']=GLYPH(07,04,07,05,07), ['7']=GLYPH(07,01,01,01,01), ['8']=GLYPH(07,05,07,05,07),
+    ['9']=GLYPH(07,05,07,01,07),
+    ['A']=GLYPH(02,05,07,05,05), ['B']=GLYPH(06,05,06,05,06), ['C']=GLYPH(03,04,04,04,03),
+    ['D']=GLYPH(06,05,05,05,06), ['E']=GLYPH(07,04,06,04,07), ['F']=GLYPH(07,04,06,04,04),
+    ['G']=GLYPH(03,04,05,05,03), ['H']=GLYPH(05,05,07,05,05), ['I']=GLYPH(07,02,02,02,07),
+    ['J']=GLYPH(01,01,01,05,02), ['K']=GLYPH(05,05,06,05,05), ['L']=GLYPH(04,04,04,04,07),
+    ['M']=GLYPH(05,07,07,05,05), ['N']=GLYPH(06,05,05,05,05), ['O']=GLYPH(02,05,05,05,02),
+    ['P']=GLYPH(06,05,06,04,04), ['Q']=GLYPH(02,05,05,06,03), ['R']=GLYPH(06,05,06,05,05),
+    ['S']=GLYPH(03,04,02,01,06), ['T']=GLYPH(07,02,02,02,02), ['U']=GLYPH(05,05,05,05,07),
+    ['V']=GLYPH(05,05,05,05,02), ['W']=GLYPH(05,05,07,07,05), ['X']=GLYPH(05,05,02,05,05),
+    ['Y']=GLYPH(05,05,02,02,02), ['Z']=GLYPH(07,01,02,04,07),
+    ['.']=GLYPH(00,00,00,00,02), ['%']=GLYPH(05,01,02,04,05), [':']=GLYPH(00,02,00,02,00),
+    ['/']=GLYPH(01,01,02,04,04), ['-']=GLYPH(00,00,07,00,00)
+};
+
+//Graph colours: emulation, screen conversion, present, and the 60 Hz budget line
+static const uint8_t emu_color[3]={0x40, 0xE0, 0x40};
+static const uint8_t convert_color[3]={0xF0, 0xD0, 0x20};
+static const uint8_t present_color[3]={0x50, 0x80, 0xF0};
+static const uint8_t budget_color[3]={0xF0, 0x30, 0x30};
+
+hud_t* hud_init(){
+    return calloc(1, sizeof(hud_t));
+}
+
+void hud_destroy(hud_t* hud){
+    free(hud);
+}
+
+static int compare_u32(const void* a, const void* b){
+    uint32_t x=*(const uint32_t*)a;
+    uint32_t y=*(const uint32_t*)b;
+
+    return (x>y)-(x<y);
+}
+
+//Recomputes the figures on display from the totals of the period that just ended
+static void hud_update(hud_t* hud, uint64_t now){
+    float elapsed_us=now-hud->period_start_us;
+    int n=hud->num_intervals;
+
+    hud->avg_emu_ms=hud->emu_us / 1000.0f / hud->frames;
+    hud->avg_convert_ms=hud->convert_us / 1000.0f / hud->frames;
+    hud->avg_present_ms=hud->present_us / 1000.0f / hud->frames;
+    hud->mhz=hud->cycles / elapsed_us;
+    hud->fps=hud->frames * 1000000.0f / elapsed_us;
+
+    //1% low: the frame rate over the slowest 1% of the recent frames
+    if(n>0){
+        int worst=n/100 ? n/100 : 1;
+        uint64_t sum=0;
+
+        memcpy(hud->sorted, hud->intervals, sizeof(uint32_t) * n);
+        qsort(hud->sorted, n, sizeof(uint32_t), compare_u32);
+
+        for(int i=n-worst; i<n; i++){
+            sum+=hud->sorted[i];
+        }
+
+        hud->low_fps=sum ? worst * 1000000.0f / sum : 0;
+    }
+
+    hud->period_start_us=now;
+    hud->emu_us=hud->convert_us=hud->present_us=0;
+    hud->cycles=0;
+    hud->frames=0;
+}
+
+void hud_frame(hud_t* hud, uint32_t emu_us, uint32_t convert_us, uint32_t present_us, uint32_t cycles){
+    uint64_t now=latency_now_us();
+
+    if(hud->last_frame_us){
+        hud->intervals[hud->next_interval]=now-hud->last_frame_us;
+        hud->next_interval=(hud->next_interval+1) % HUD_WINDOW;
+        if(hud->num_intervals<HUD_WINDOW){
+            hud->num_intervals++;
+        }
+    }
+    else{
+        hud->period_start_us=now;
+    }
+
+    hud->last_frame_us=now;
+
+    hud->graph_emu[hud->graph_next]=emu_us<UINT16_MAX ? emu_us : UINT16_MAX;
+    hud->graph_convert[hud->graph_next]=convert_us<UINT16_MAX ? convert_us : UINT16_MAX;
+    hud->graph_present[hud->graph_next]=present_us<UINT16_MAX ? present_us : UINT16_MAX;
+    hud->graph_next=(hud->graph_next+1) % HUD_GRAPH_FRAMES;
+
+    hud->emu_us+=emu_us;
+    hud->convert_us+=convert_us;
+    hud->present_us+=present_us;
+    hud->cycles+=cycles;
+    hud->frames++;
+
+    if(now-hud->period_start_us>=HUD_UPDATE_US){
+        hud_update(hud, now);
+    }
+}
+
+static void draw_text(uint8_t pixels[SCREEN_HEIGHT][SCREEN_WIDTH][3], int x, int y, const char* text){
+    for(; *text && x+3<=SCREEN_WIDTH; text++, x+=HUD_GLYPH_WIDTH){
+        uint16_t glyph=font[*text & 0x7F];
+
+        for(int row=0; row<5; row++){
+            for(int col=0; col<3; col++){
+                if(glyph & (1 << ((4-row)*3 + 2-col))){
+                    memset(pixels[y+row][x+col], 0xFF, 3);
+                }
+            }
+        }
+    }
+}
+
+//Stacks one segment of a graph bar, returns the row above it
+static int draw_segment(uint8_t pixels[SCREEN_HEIGHT][SCREEN_WIDTH][3], int x, int bottom, int top,
+                        uint32_t us, const uint8_t color[3]){
+    int y=bottom - (int)(us / HUD_US_PER_PIXEL);
+
+    if(y<top){
+        y=top;
+    }
+
+    for(int row=bottom; row>y; row--){
+        memcpy(pixels[row][x], color, 3);
+    }
+
+    return y;
+}
+
+void hud_draw(hud_t* hud, uint8_t pixels[SCREEN_HEIGHT][SCREEN_WIDTH][3]){
+    char line[SCREEN_WIDTH / HUD_GLYPH_WIDTH + 1];
+
+    //Darken the band behind the overlay so it reads over the game
+    for(int y=0; y<HUD_HEIGHT; y++){
+        uint8_t* row=pixels[y][0];
+
+        for(int i=0; i<SCREEN_WIDTH*3; i++){
+            row[i]>>=2;
+        }
+    }
+
+    int y=HUD_MARGIN;
+
+    snprintf(line, sizeof(line), "EMU %5.2f  SCR %5.2f  PRS %5.2f MS",
+             hud->avg_emu_ms, hud->avg_convert_ms, hud->avg_present_ms);
+    draw_text(pixels, HUD_MARGIN, y, line);
+    y+=HUD_LINE_HEIGHT;
+
+    snprintf(line, sizeof(line), "%4.2f MHZ  %5.1f FPS  1%% LOW %5.1f", hud->mhz, hud->fps, hud->low_fps);
+    draw_text(pixels, HUD_MARGIN, y, line);
+    y+=HUD_LINE_HEIGHT;
+
+    //Frame-time graph, oldest frame on the left, with the 60 Hz budget marked
+    int top=y;
+    int bottom=y+HUD_GRAPH_HEIGHT-1;
+    int budget=bottom - 1000000 / FPS / HUD_US_PER_PIXEL;
+
+    for(int i=0; i<HUD_GRAPH_FRAMES; i++){
+        int frame=(hud->graph_next+i) % HUD_GRAPH_FRAMES;
+        int x=HUD_MARGIN+i;
+        int row=bottom;
+
+        row=draw_segment(pixels, x, row, top, hud->graph_emu[frame], emu_color);
+        row=draw_segment(pixels, x, row, top, hud->graph_convert[frame], convert_color);
+        draw_segment(pixels, x, row, top, hud->graph_present[frame], present_color);
+
+        if(i%2==0){
+            memcpy(pixels[budget][x], budget_color, 3);
+        }
+    }
+}
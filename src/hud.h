@@ -0,0 +1,53 @@
+#ifndef hud_H
+#define hud_H
+
+#include <stdint.h>
+
+#include "machine.h"
+
+#define HUD_WINDOW		1024		//Frame intervals kept for the 1% low
+#define HUD_GRAPH_FRAMES	128		//Frames shown in the frame-time graph, one pixel each
+#define HUD_UPDATE_US		500000		//How often the figures are recomputed
+
+/*Performance overlay drawn into the framebuffer. Everything it needs is allocated by
+hud_init(), recording a frame and drawing cost a few microseconds*/
+typedef struct{
+    uint64_t last_frame_us;		//Host time of the previous hud_frame()
+
+    //Frame intervals in microseconds, for the 1% low
+    uint32_t intervals[HUD_WINDOW];
+    uint32_t sorted[HUD_WINDOW];
+    int num_intervals;
+    int next_interval;
+
+    //Per-frame split for the graph, oldest first from graph_next
+    uint16_t graph_emu[HUD_GRAPH_FRAMES];
+    uint16_t graph_convert[HUD_GRAPH_FRAMES];
+    uint16_t graph_present[HUD_GRAPH_FRAMES];
+    int graph_next;
+
+    //Totals since the figures were last recomputed
+    uint64_t period_start_us;
+    uint64_t emu_us, convert_us, present_us;
+    uint64_t cycles;
+    int frames;
+
+    //Figures on display
+    float avg_emu_ms, avg_convert_ms, avg_present_ms;
+    float mhz;
+    float fps;
+    float low_fps;
+} hud_t;
+
+hud_t* hud_init();
+
+void hud_destroy(hud_t* hud);
+
+//Records one presented frame: host time spent emulating, converting VRAM and
+//presenting, and the CPU cycles it emulated
+void hud_frame(hud_t* hud, uint32_t emu_us, uint32_t convert_us, uint32_t present_us, uint32_t cycles);
+
+//Draws the overlay over the top of the screen
+void hud_draw(hud_t* hud, uint8_t pixels[SCREEN_HEIGHT][SCREEN_WIDTH][3]);
+
+#endif
@@ -4,37 +4,50 @@
 #include <inttypes.h>
 #include <string.h>
 
+/*Status flags, laid out as the flag byte of the PSW (S Z 0 AC 0 P 1 CY from bit 7
+down) so the flags and A together form the AF register pair. The fixed bits are
+left clear here and filled in by i8080_get_psw()*/
 typedef struct {
-    uint8_t S:1;    //Sign flag
-    uint8_t Z:1;    //Zero flag
-    uint8_t P:1;    //Polarity flag
     uint8_t C:1;    //Carry flag
+    uint8_t :1;
+    uint8_t P:1;    //Polarity flag
+    uint8_t :1;
     uint8_t AC:1;   //Auxiliary carry flag
+    uint8_t :1;
+    uint8_t Z:1;    //Zero flag
+    uint8_t S:1;    //Sign flag
 } status_flags;
 
-typedef struct{
-    //Accumulator register A
-    uint8_t A;
-
-    //Other data registers:
-    uint8_t B;
-    uint8_t C;
-    uint8_t D;
-    uint8_t E;
-    uint8_t H;
-    uint8_t L;
-    uint16_t SP;    //Stack Pointer
+//The register pair and flag layouts assume a little-endian host
+#if __BYTE_ORDER__==__ORDER_BIG_ENDIAN__
+#error "i8080 register layout needs a little-endian host"
+#endif
 
+//A register pair, readable as one 16-bit value or as its two 8-bit halves
+#define REGISTER_PAIR(pair, high, low) union{ uint16_t pair; struct{ low; high; }; }
+
+/*Everything an instruction touches sits at the start of the struct, within one
+64-byte cache line*/
+typedef struct{
     uint16_t PC;    //Program Counter
+    uint16_t SP;    //Stack Pointer
 
-    uint8_t *memory;      //Pointer to a memory space,
+    //Data registers, as pairs BC, DE and HL or as B, C, D, E, H and L
+    REGISTER_PAIR(BC, uint8_t B, uint8_t C);
+    REGISTER_PAIR(DE, uint8_t D, uint8_t E);
+    REGISTER_PAIR(HL, uint8_t H, uint8_t L);
 
-    status_flags flags;   //Status register flags
+    //Accumulator register A and the status register flags (PSW)
+    REGISTER_PAIR(AF, uint8_t A, union{ status_flags flags; uint8_t F; });
 
-    int interrupt_enable;
     int instruction_cycles;
+    int interrupt_enable;
 
-} i8080;
+    uint8_t *memory;          //Pointer to a memory space,
+    uint16_t address_mask;    //Addresses are ANDed with this, memory holds address_mask+1 bytes
+    uint16_t rom_size;        //Writes below this address are ignored (0 = no ROM)
+
+} __attribute__((aligned(64))) i8080;
 
 uint8_t read_mem(i8080* cpu, uint16_t addr);
 
@@ -44,9 +57,19 @@ void i8080_emulator(i8080* cpu);
 //Initialize an i8080 cpu
 i8080* i8080_init();
 
+//Puts a cpu that lives somewhere else (e.g. inside a machine struct) into the
+//state i8080_init() returns
+void i8080_reset(i8080* cpu);
+
 //Generates an interrupt with a specific interrupt number (int_num)
 void RST(i8080* cpu, uint8_t int_num);
 
+//Packs the status flags into the PSW byte layout used by PUSH PSW
+uint8_t i8080_get_psw(i8080* cpu);
+
+//Unpacks a PSW byte into the status flags, like POP PSW
+void i8080_set_psw(i8080* cpu, uint8_t psw);
+
 //Prints the value of i8080's registers, flags, PC and SP pointers
 void print_values(i8080* cpu);
 
@@ -0,0 +1,8 @@
+#include "i8080_opcodes.h"
+
+#define OPCODE_ENTRY(op, mnemonic, operands, kind, length, flow, undocumented, cycles, taken, reads, writes, exec) \
+    [op]={mnemonic, operands, kind, length, flow, undocumented, cycles, taken, reads, writes},
+
+const i8080_opcode_t i8080_opcodes[256]={
+    I8080_OPCODE_TABLE(OPCODE_ENTRY)
+};
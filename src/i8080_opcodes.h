@@ -0,0 +1,313 @@
+#ifndef i8080_opcodes_H
+#define i8080_opcodes_H
+
+#include <stdint.h>
+
+//How the bytes following the opcode are used
+enum operand_kind{OPERAND_NONE, OPERAND_D8, OPERAND_D16, OPERAND_A16, OPERAND_PORT};
+
+//How an instruction affects the flow of control (used for static code discovery)
+enum flow_kind{
+    FLOW_NEXT,          //Falls through to the next instruction
+    FLOW_JUMP,          //Unconditional jump to the address operand
+    FLOW_BRANCH,        //Conditional jump, may also fall through
+    FLOW_CALL,          //Call to the address operand, returns to the next instruction
+    FLOW_RET,           //Unconditional return
+    FLOW_RET_COND,      //Conditional return, may also fall through
+    FLOW_RST,           //Call to 8 * n
+    FLOW_INDIRECT,      //Jump through a register (PCHL), target unknown statically
+    FLOW_HALT
+};
+
+//Status flags as bits of the PSW byte, for the flags read/written columns
+#define FLAG_CY         0x01
+#define FLAG_P          0x04
+#define FLAG_AC         0x10
+#define FLAG_Z          0x40
+#define FLAG_S          0x80
+#define FLAGS_NONE      0x00
+#define FLAGS_SZAP      (FLAG_S|FLAG_Z|FLAG_AC|FLAG_P)
+#define FLAGS_ALL       (FLAGS_SZAP|FLAG_CY)
+
+/*One row per opcode, the single source of opcode knowledge:
+X(opcode, mnemonic, register operands, operand kind, length, flow, undocumented,
+  cycles, extra cycles when taken, flags read, flags written, handler)
+
+Register operands are printed before any immediate operand, e.g. LXI B,#$1234.
+Undocumented opcodes are aliases the real 8080 decodes like their documented twin.
+The extra cycles are added when a conditional CALL or RET is taken. The handler
+is only expanded by i8080_cpu.c, which defines the OP_* macros*/
+#define I8080_OPCODE_TABLE(X) \
+    X(0x00, "NOP",  "",    OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_NONE, OP_NOP())          \
+    X(0x01, "LXI",  "B",   OPERAND_D16,  3, FLOW_NEXT,     0, 10, 0, FLAGS_NONE,      FLAGS_NONE, OP_LXI(BC))        \
+    X(0x02, "STAX", "B",   OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_STAX(BC))       \
+    X(0x03, "INX",  "B",   OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_INX(BC))        \
+    X(0x04, "INR",  "B",   OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_SZAP, OP_INR(B))         \
+    X(0x05, "DCR",  "B",   OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_SZAP, OP_DCR(B))         \
+    X(0x06, "MVI",  "B",   OPERAND_D8,   2, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_MVI(B))         \
+    X(0x07, "RLC",  "",    OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAG_CY,    OP_RLC())          \
+    X(0x08, "NOP",  "",    OPERAND_NONE, 1, FLOW_NEXT,     1, 4,  0, FLAGS_NONE,      FLAGS_NONE, OP_NOP())          \
+    X(0x09, "DAD",  "B",   OPERAND_NONE, 1, FLOW_NEXT,     0, 10, 0, FLAGS_NONE,      FLAG_CY,    OP_DAD(BC))        \
+    X(0x0A, "LDAX", "B",   OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_LDAX(BC))       \
+    X(0x0B, "DCX",  "B",   OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_DCX(BC))        \
+    X(0x0C, "INR",  "C",   OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_SZAP, OP_INR(C))         \
+    X(0x0D, "DCR",  "C",   OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_SZAP, OP_DCR(C))         \
+    X(0x0E, "MVI",  "C",   OPERAND_D8,   2, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_MVI(C))         \
+    X(0x0F, "RRC",  "",    OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAG_CY,    OP_RRC())          \
+    X(0x10, "NOP",  "",    OPERAND_NONE, 1, FLOW_NEXT,     1, 4,  0, FLAGS_NONE,      FLAGS_NONE, OP_NOP())          \
+    X(0x11, "LXI",  "D",   OPERAND_D16,  3, FLOW_NEXT,     0, 10, 0, FLAGS_NONE,      FLAGS_NONE, OP_LXI(DE))        \
+    X(0x12, "STAX", "D",   OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_STAX(DE))       \
+    X(0x13, "INX",  "D",   OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_INX(DE))        \
+    X(0x14, "INR",  "D",   OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_SZAP, OP_INR(D))         \
+    X(0x15, "DCR",  "D",   OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_SZAP, OP_DCR(D))         \
+    X(0x16, "MVI",  "D",   OPERAND_D8,   2, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_MVI(D))         \
+    X(0x17, "RAL",  "",    OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAG_CY,         FLAG_CY,    OP_RAL())          \
+    X(0x18, "NOP",  "",    OPERAND_NONE, 1, FLOW_NEXT,     1, 4,  0, FLAGS_NONE,      FLAGS_NONE, OP_NOP())          \
+    X(0x19, "DAD",  "D",   OPERAND_NONE, 1, FLOW_NEXT,     0, 10, 0, FLAGS_NONE,      FLAG_CY,    OP_DAD(DE))        \
+    X(0x1A, "LDAX", "D",   OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_LDAX(DE))       \
+    X(0x1B, "DCX",  "D",   OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_DCX(DE))        \
+    X(0x1C, "INR",  "E",   OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_SZAP, OP_INR(E))         \
+    X(0x1D, "DCR",  "E",   OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_SZAP, OP_DCR(E))         \
+    X(0x1E, "MVI",  "E",   OPERAND_D8,   2, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_MVI(E))         \
+    X(0x1F, "RAR",  "",    OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAG_CY,         FLAG_CY,    OP_RAR())          \
+    X(0x20, "NOP",  "",    OPERAND_NONE, 1, FLOW_NEXT,     1, 4,  0, FLAGS_NONE,      FLAGS_NONE, OP_NOP())          \
+    X(0x21, "LXI",  "H",   OPERAND_D16,  3, FLOW_NEXT,     0, 10, 0, FLAGS_NONE,      FLAGS_NONE, OP_LXI(HL))        \
+    X(0x22, "SHLD", "",    OPERAND_A16,  3, FLOW_NEXT,     0, 16, 0, FLAGS_NONE,      FLAGS_NONE, OP_SHLD())         \
+    X(0x23, "INX",  "H",   OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_INX(HL))        \
+    X(0x24, "INR",  "H",   OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_SZAP, OP_INR(H))         \
+    X(0x25, "DCR",  "H",   OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_SZAP, OP_DCR(H))         \
+    X(0x26, "MVI",  "H",   OPERAND_D8,   2, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_MVI(H))         \
+    X(0x27, "DAA",  "",    OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAG_CY|FLAG_AC, FLAGS_ALL,  OP_DAA())          \
+    X(0x28, "NOP",  "",    OPERAND_NONE, 1, FLOW_NEXT,     1, 4,  0, FLAGS_NONE,      FLAGS_NONE, OP_NOP())          \
+    X(0x29, "DAD",  "H",   OPERAND_NONE, 1, FLOW_NEXT,     0, 10, 0, FLAGS_NONE,      FLAG_CY,    OP_DAD(HL))        \
+    X(0x2A, "LHLD", "",    OPERAND_A16,  3, FLOW_NEXT,     0, 16, 0, FLAGS_NONE,      FLAGS_NONE, OP_LHLD())         \
+    X(0x2B, "DCX",  "H",   OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_DCX(HL))        \
+    X(0x2C, "INR",  "L",   OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_SZAP, OP_INR(L))         \
+    X(0x2D, "DCR",  "L",   OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_SZAP, OP_DCR(L))         \
+    X(0x2E, "MVI",  "L",   OPERAND_D8,   2, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_MVI(L))         \
+    X(0x2F, "CMA",  "",    OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_NONE, OP_CMA())          \
+    X(0x30, "NOP",  "",    OPERAND_NONE, 1, FLOW_NEXT,     1, 4,  0, FLAGS_NONE,      FLAGS_NONE, OP_NOP())          \
+    X(0x31, "LXI",  "SP",  OPERAND_D16,  3, FLOW_NEXT,     0, 10, 0, FLAGS_NONE,      FLAGS_NONE, OP_LXI(SP))        \
+    X(0x32, "STA",  "",    OPERAND_A16,  3, FLOW_NEXT,     0, 13, 0, FLAGS_NONE,      FLAGS_NONE, OP_STA())          \
+    X(0x33, "INX",  "SP",  OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_INX(SP))        \
+    X(0x34, "INR",  "M",   OPERAND_NONE, 1, FLOW_NEXT,     0, 10, 0, FLAGS_NONE,      FLAGS_SZAP, OP_INR_M())        \
+    X(0x35, "DCR",  "M",   OPERAND_NONE, 1, FLOW_NEXT,     0, 10, 0, FLAGS_NONE,      FLAGS_SZAP, OP_DCR_M())        \
+    X(0x36, "MVI",  "M",   OPERAND_D8,   2, FLOW_NEXT,     0, 10, 0, FLAGS_NONE,      FLAGS_NONE, OP_MVI_M())        \
+    X(0x37, "STC",  "",    OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAG_CY,    OP_STC())          \
+    X(0x38, "NOP",  "",    OPERAND_NONE, 1, FLOW_NEXT,     1, 4,  0, FLAGS_NONE,      FLAGS_NONE, OP_NOP())          \
+    X(0x39, "DAD",  "SP",  OPERAND_NONE, 1, FLOW_NEXT,     0, 10, 0, FLAGS_NONE,      FLAG_CY,    OP_DAD(SP))        \
+    X(0x3A, "LDA",  "",    OPERAND_A16,  3, FLOW_NEXT,     0, 13, 0, FLAGS_NONE,      FLAGS_NONE, OP_LDA())          \
+    X(0x3B, "DCX",  "SP",  OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_DCX(SP))        \
+    X(0x3C, "INR",  "A",   OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_SZAP, OP_INR(A))         \
+    X(0x3D, "DCR",  "A",   OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_SZAP, OP_DCR(A))         \
+    X(0x3E, "MVI",  "A",   OPERAND_D8,   2, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_MVI(A))         \
+    X(0x3F, "CMC",  "",    OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAG_CY,         FLAG_CY,    OP_CMC())          \
+    X(0x40, "MOV",  "B,B", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(B, B))      \
+    X(0x41, "MOV",  "B,C", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(B, C))      \
+    X(0x42, "MOV",  "B,D", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(B, D))      \
+    X(0x43, "MOV",  "B,E", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(B, E))      \
+    X(0x44, "MOV",  "B,H", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(B, H))      \
+    X(0x45, "MOV",  "B,L", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(B, L))      \
+    X(0x46, "MOV",  "B,M", OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV_RM(B))      \
+    X(0x47, "MOV",  "B,A", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(B, A))      \
+    X(0x48, "MOV",  "C,B", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(C, B))      \
+    X(0x49, "MOV",  "C,C", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(C, C))      \
+    X(0x4A, "MOV",  "C,D", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(C, D))      \
+    X(0x4B, "MOV",  "C,E", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(C, E))      \
+    X(0x4C, "MOV",  "C,H", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(C, H))      \
+    X(0x4D, "MOV",  "C,L", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(C, L))      \
+    X(0x4E, "MOV",  "C,M", OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV_RM(C))      \
+    X(0x4F, "MOV",  "C,A", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(C, A))      \
+    X(0x50, "MOV",  "D,B", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(D, B))      \
+    X(0x51, "MOV",  "D,C", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(D, C))      \
+    X(0x52, "MOV",  "D,D", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(D, D))      \
+    X(0x53, "MOV",  "D,E", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(D, E))      \
+    X(0x54, "MOV",  "D,H", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(D, H))      \
+    X(0x55, "MOV",  "D,L", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(D, L))      \
+    X(0x56, "MOV",  "D,M", OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV_RM(D))      \
+    X(0x57, "MOV",  "D,A", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(D, A))      \
+    X(0x58, "MOV",  "E,B", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(E, B))      \
+    X(0x59, "MOV",  "E,C", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(E, C))      \
+    X(0x5A, "MOV",  "E,D", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(E, D))      \
+    X(0x5B, "MOV",  "E,E", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(E, E))      \
+    X(0x5C, "MOV",  "E,H", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(E, H))      \
+    X(0x5D, "MOV",  "E,L", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(E, L))      \
+    X(0x5E, "MOV",  "E,M", OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV_RM(E))      \
+    X(0x5F, "MOV",  "E,A", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(E, A))      \
+    X(0x60, "MOV",  "H,B", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(H, B))      \
+    X(0x61, "MOV",  "H,C", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(H, C))      \
+    X(0x62, "MOV",  "H,D", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(H, D))      \
+    X(0x63, "MOV",  "H,E", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(H, E))      \
+    X(0x64, "MOV",  "H,H", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(H, H))      \
+    X(0x65, "MOV",  "H,L", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(H, L))      \
+    X(0x66, "MOV",  "H,M", OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV_RM(H))      \
+    X(0x67, "MOV",  "H,A", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(H, A))      \
+    X(0x68, "MOV",  "L,B", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(L, B))      \
+    X(0x69, "MOV",  "L,C", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(L, C))      \
+    X(0x6A, "MOV",  "L,D", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(L, D))      \
+    X(0x6B, "MOV",  "L,E", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(L, E))      \
+    X(0x6C, "MOV",  "L,H", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(L, H))      \
+    X(0x6D, "MOV",  "L,L", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(L, L))      \
+    X(0x6E, "MOV",  "L,M", OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV_RM(L))      \
+    X(0x6F, "MOV",  "L,A", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(L, A))      \
+    X(0x70, "MOV",  "M,B", OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV_MR(B))      \
+    X(0x71, "MOV",  "M,C", OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV_MR(C))      \
+    X(0x72, "MOV",  "M,D", OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV_MR(D))      \
+    X(0x73, "MOV",  "M,E", OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV_MR(E))      \
+    X(0x74, "MOV",  "M,H", OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV_MR(H))      \
+    X(0x75, "MOV",  "M,L", OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV_MR(L))      \
+    X(0x76, "HLT",  "",    OPERAND_NONE, 1, FLOW_HALT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_HLT())          \
+    X(0x77, "MOV",  "M,A", OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV_MR(A))      \
+    X(0x78, "MOV",  "A,B", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(A, B))      \
+    X(0x79, "MOV",  "A,C", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(A, C))      \
+    X(0x7A, "MOV",  "A,D", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(A, D))      \
+    X(0x7B, "MOV",  "A,E", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(A, E))      \
+    X(0x7C, "MOV",  "A,H", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(A, H))      \
+    X(0x7D, "MOV",  "A,L", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(A, L))      \
+    X(0x7E, "MOV",  "A,M", OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV_RM(A))      \
+    X(0x7F, "MOV",  "A,A", OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_MOV(A, A))      \
+    X(0x80, "ADD",  "B",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ADD(REG(B)))    \
+    X(0x81, "ADD",  "C",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ADD(REG(C)))    \
+    X(0x82, "ADD",  "D",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ADD(REG(D)))    \
+    X(0x83, "ADD",  "E",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ADD(REG(E)))    \
+    X(0x84, "ADD",  "H",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ADD(REG(H)))    \
+    X(0x85, "ADD",  "L",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ADD(REG(L)))    \
+    X(0x86, "ADD",  "M",   OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ADD(MEM_HL))    \
+    X(0x87, "ADD",  "A",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ADD(REG(A)))    \
+    X(0x88, "ADC",  "B",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAG_CY,         FLAGS_ALL,  OP_ADC(REG(B)))    \
+    X(0x89, "ADC",  "C",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAG_CY,         FLAGS_ALL,  OP_ADC(REG(C)))    \
+    X(0x8A, "ADC",  "D",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAG_CY,         FLAGS_ALL,  OP_ADC(REG(D)))    \
+    X(0x8B, "ADC",  "E",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAG_CY,         FLAGS_ALL,  OP_ADC(REG(E)))    \
+    X(0x8C, "ADC",  "H",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAG_CY,         FLAGS_ALL,  OP_ADC(REG(H)))    \
+    X(0x8D, "ADC",  "L",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAG_CY,         FLAGS_ALL,  OP_ADC(REG(L)))    \
+    X(0x8E, "ADC",  "M",   OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAG_CY,         FLAGS_ALL,  OP_ADC(MEM_HL))    \
+    X(0x8F, "ADC",  "A",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAG_CY,         FLAGS_ALL,  OP_ADC(REG(A)))    \
+    X(0x90, "SUB",  "B",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_SUB(REG(B)))    \
+    X(0x91, "SUB",  "C",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_SUB(REG(C)))    \
+    X(0x92, "SUB",  "D",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_SUB(REG(D)))    \
+    X(0x93, "SUB",  "E",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_SUB(REG(E)))    \
+    X(0x94, "SUB",  "H",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_SUB(REG(H)))    \
+    X(0x95, "SUB",  "L",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_SUB(REG(L)))    \
+    X(0x96, "SUB",  "M",   OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_ALL,  OP_SUB(MEM_HL))    \
+    X(0x97, "SUB",  "A",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_SUB(REG(A)))    \
+    X(0x98, "SBB",  "B",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAG_CY,         FLAGS_ALL,  OP_SBB(REG(B)))    \
+    X(0x99, "SBB",  "C",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAG_CY,         FLAGS_ALL,  OP_SBB(REG(C)))    \
+    X(0x9A, "SBB",  "D",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAG_CY,         FLAGS_ALL,  OP_SBB(REG(D)))    \
+    X(0x9B, "SBB",  "E",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAG_CY,         FLAGS_ALL,  OP_SBB(REG(E)))    \
+    X(0x9C, "SBB",  "H",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAG_CY,         FLAGS_ALL,  OP_SBB(REG(H)))    \
+    X(0x9D, "SBB",  "L",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAG_CY,         FLAGS_ALL,  OP_SBB(REG(L)))    \
+    X(0x9E, "SBB",  "M",   OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAG_CY,         FLAGS_ALL,  OP_SBB(MEM_HL))    \
+    X(0x9F, "SBB",  "A",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAG_CY,         FLAGS_ALL,  OP_SBB(REG(A)))    \
+    X(0xA0, "ANA",  "B",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ANA(REG(B)))    \
+    X(0xA1, "ANA",  "C",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ANA(REG(C)))    \
+    X(0xA2, "ANA",  "D",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ANA(REG(D)))    \
+    X(0xA3, "ANA",  "E",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ANA(REG(E)))    \
+    X(0xA4, "ANA",  "H",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ANA(REG(H)))    \
+    X(0xA5, "ANA",  "L",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ANA(REG(L)))    \
+    X(0xA6, "ANA",  "M",   OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ANA(MEM_HL))    \
+    X(0xA7, "ANA",  "A",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ANA(REG(A)))    \
+    X(0xA8, "XRA",  "B",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_XRA(REG(B)))    \
+    X(0xA9, "XRA",  "C",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_XRA(REG(C)))    \
+    X(0xAA, "XRA",  "D",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_XRA(REG(D)))    \
+    X(0xAB, "XRA",  "E",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_XRA(REG(E)))    \
+    X(0xAC, "XRA",  "H",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_XRA(REG(H)))    \
+    X(0xAD, "XRA",  "L",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_XRA(REG(L)))    \
+    X(0xAE, "XRA",  "M",   OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_ALL,  OP_XRA(MEM_HL))    \
+    X(0xAF, "XRA",  "A",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_XRA(REG(A)))    \
+    X(0xB0, "ORA",  "B",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ORA(REG(B)))    \
+    X(0xB1, "ORA",  "C",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ORA(REG(C)))    \
+    X(0xB2, "ORA",  "D",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ORA(REG(D)))    \
+    X(0xB3, "ORA",  "E",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ORA(REG(E)))    \
+    X(0xB4, "ORA",  "H",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ORA(REG(H)))    \
+    X(0xB5, "ORA",  "L",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ORA(REG(L)))    \
+    X(0xB6, "ORA",  "M",   OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ORA(MEM_HL))    \
+    X(0xB7, "ORA",  "A",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ORA(REG(A)))    \
+    X(0xB8, "CMP",  "B",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_CMP(REG(B)))    \
+    X(0xB9, "CMP",  "C",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_CMP(REG(C)))    \
+    X(0xBA, "CMP",  "D",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_CMP(REG(D)))    \
+    X(0xBB, "CMP",  "E",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_CMP(REG(E)))    \
+    X(0xBC, "CMP",  "H",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_CMP(REG(H)))    \
+    X(0xBD, "CMP",  "L",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_CMP(REG(L)))    \
+    X(0xBE, "CMP",  "M",   OPERAND_NONE, 1, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_ALL,  OP_CMP(MEM_HL))    \
+    X(0xBF, "CMP",  "A",   OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_ALL,  OP_CMP(REG(A)))    \
+    X(0xC0, "RNZ",  "",    OPERAND_NONE, 1, FLOW_RET_COND, 0, 5,  6, FLAG_Z,          FLAGS_NONE, OP_RET_IF(IF_NZ))  \
+    X(0xC1, "POP",  "B",   OPERAND_NONE, 1, FLOW_NEXT,     0, 10, 0, FLAGS_NONE,      FLAGS_NONE, OP_POP(BC))        \
+    X(0xC2, "JNZ",  "",    OPERAND_A16,  3, FLOW_BRANCH,   0, 10, 0, FLAG_Z,          FLAGS_NONE, OP_JMP_IF(IF_NZ))  \
+    X(0xC3, "JMP",  "",    OPERAND_A16,  3, FLOW_JUMP,     0, 10, 0, FLAGS_NONE,      FLAGS_NONE, OP_JMP())          \
+    X(0xC4, "CNZ",  "",    OPERAND_A16,  3, FLOW_CALL,     0, 11, 6, FLAG_Z,          FLAGS_NONE, OP_CALL_IF(IF_NZ)) \
+    X(0xC5, "PUSH", "B",   OPERAND_NONE, 1, FLOW_NEXT,     0, 11, 0, FLAGS_NONE,      FLAGS_NONE, OP_PUSH(BC))       \
+    X(0xC6, "ADI",  "",    OPERAND_D8,   2, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ADD(IMM8))      \
+    X(0xC7, "RST",  "0",   OPERAND_NONE, 1, FLOW_RST,      0, 11, 0, FLAGS_NONE,      FLAGS_NONE, OP_RST(0))         \
+    X(0xC8, "RZ",   "",    OPERAND_NONE, 1, FLOW_RET_COND, 0, 5,  6, FLAG_Z,          FLAGS_NONE, OP_RET_IF(IF_Z))   \
+    X(0xC9, "RET",  "",    OPERAND_NONE, 1, FLOW_RET,      0, 10, 0, FLAGS_NONE,      FLAGS_NONE, OP_RET())          \
+    X(0xCA, "JZ",   "",    OPERAND_A16,  3, FLOW_BRANCH,   0, 10, 0, FLAG_Z,          FLAGS_NONE, OP_JMP_IF(IF_Z))   \
+    X(0xCB, "JMP",  "",    OPERAND_A16,  3, FLOW_JUMP,     1, 10, 0, FLAGS_NONE,      FLAGS_NONE, OP_JMP())          \
+    X(0xCC, "CZ",   "",    OPERAND_A16,  3, FLOW_CALL,     0, 11, 6, FLAG_Z,          FLAGS_NONE, OP_CALL_IF(IF_Z))  \
+    X(0xCD, "CALL", "",    OPERAND_A16,  3, FLOW_CALL,     0, 17, 0, FLAGS_NONE,      FLAGS_NONE, OP_CALL())         \
+    X(0xCE, "ACI",  "",    OPERAND_D8,   2, FLOW_NEXT,     0, 7,  0, FLAG_CY,         FLAGS_ALL,  OP_ADC(IMM8))      \
+    X(0xCF, "RST",  "1",   OPERAND_NONE, 1, FLOW_RST,      0, 11, 0, FLAGS_NONE,      FLAGS_NONE, OP_RST(1))         \
+    X(0xD0, "RNC",  "",    OPERAND_NONE, 1, FLOW_RET_COND, 0, 5,  6, FLAG_CY,         FLAGS_NONE, OP_RET_IF(IF_NC))  \
+    X(0xD1, "POP",  "D",   OPERAND_NONE, 1, FLOW_NEXT,     0, 10, 0, FLAGS_NONE,      FLAGS_NONE, OP_POP(DE))        \
+    X(0xD2, "JNC",  "",    OPERAND_A16,  3, FLOW_BRANCH,   0, 10, 0, FLAG_CY,         FLAGS_NONE, OP_JMP_IF(IF_NC))  \
+    X(0xD3, "OUT",  "",    OPERAND_PORT, 2, FLOW_NEXT,     0, 10, 0, FLAGS_NONE,      FLAGS_NONE, OP_OUT())          \
+    X(0xD4, "CNC",  "",    OPERAND_A16,  3, FLOW_CALL,     0, 11, 6, FLAG_CY,         FLAGS_NONE, OP_CALL_IF(IF_NC)) \
+    X(0xD5, "PUSH", "D",   OPERAND_NONE, 1, FLOW_NEXT,     0, 11, 0, FLAGS_NONE,      FLAGS_NONE, OP_PUSH(DE))       \
+    X(0xD6, "SUI",  "",    OPERAND_D8,   2, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_ALL,  OP_SUB(IMM8))      \
+    X(0xD7, "RST",  "2",   OPERAND_NONE, 1, FLOW_RST,      0, 11, 0, FLAGS_NONE,      FLAGS_NONE, OP_RST(2))         \
+    X(0xD8, "RC",   "",    OPERAND_NONE, 1, FLOW_RET_COND, 0, 5,  6, FLAG_CY,         FLAGS_NONE, OP_RET_IF(IF_C))   \
+    X(0xD9, "RET",  "",    OPERAND_NONE, 1, FLOW_RET,      1, 10, 0, FLAGS_NONE,      FLAGS_NONE, OP_RET())          \
+    X(0xDA, "JC",   "",    OPERAND_A16,  3, FLOW_BRANCH,   0, 10, 0, FLAG_CY,         FLAGS_NONE, OP_JMP_IF(IF_C))   \
+    X(0xDB, "IN",   "",    OPERAND_PORT, 2, FLOW_NEXT,     0, 10, 0, FLAGS_NONE,      FLAGS_NONE, OP_IN())           \
+    X(0xDC, "CC",   "",    OPERAND_A16,  3, FLOW_CALL,     0, 11, 6, FLAG_CY,         FLAGS_NONE, OP_CALL_IF(IF_C))  \
+    X(0xDD, "CALL", "",    OPERAND_A16,  3, FLOW_CALL,     1, 17, 0, FLAGS_NONE,      FLAGS_NONE, OP_CALL())         \
+    X(0xDE, "SBI",  "",    OPERAND_D8,   2, FLOW_NEXT,     0, 7,  0, FLAG_CY,         FLAGS_ALL,  OP_SBB(IMM8))      \
+    X(0xDF, "RST",  "3",   OPERAND_NONE, 1, FLOW_RST,      0, 11, 0, FLAGS_NONE,      FLAGS_NONE, OP_RST(3))         \
+    X(0xE0, "RPO",  "",    OPERAND_NONE, 1, FLOW_RET_COND, 0, 5,  6, FLAG_P,          FLAGS_NONE, OP_RET_IF(IF_PO))  \
+    X(0xE1, "POP",  "H",   OPERAND_NONE, 1, FLOW_NEXT,     0, 10, 0, FLAGS_NONE,      FLAGS_NONE, OP_POP(HL))        \
+    X(0xE2, "JPO",  "",    OPERAND_A16,  3, FLOW_BRANCH,   0, 10, 0, FLAG_P,          FLAGS_NONE, OP_JMP_IF(IF_PO))  \
+    X(0xE3, "XTHL", "",    OPERAND_NONE, 1, FLOW_NEXT,     0, 18, 0, FLAGS_NONE,      FLAGS_NONE, OP_XTHL())         \
+    X(0xE4, "CPO",  "",    OPERAND_A16,  3, FLOW_CALL,     0, 11, 6, FLAG_P,          FLAGS_NONE, OP_CALL_IF(IF_PO)) \
+    X(0xE5, "PUSH", "H",   OPERAND_NONE, 1, FLOW_NEXT,     0, 11, 0, FLAGS_NONE,      FLAGS_NONE, OP_PUSH(HL))       \
+    X(0xE6, "ANI",  "",    OPERAND_D8,   2, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ANA(IMM8))      \
+    X(0xE7, "RST",  "4",   OPERAND_NONE, 1, FLOW_RST,      0, 11, 0, FLAGS_NONE,      FLAGS_NONE, OP_RST(4))         \
+    X(0xE8, "RPE",  "",    OPERAND_NONE, 1, FLOW_RET_COND, 0, 5,  6, FLAG_P,          FLAGS_NONE, OP_RET_IF(IF_PE))  \
+    X(0xE9, "PCHL", "",    OPERAND_NONE, 1, FLOW_INDIRECT, 0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_PCHL())         \
+    X(0xEA, "JPE",  "",    OPERAND_A16,  3, FLOW_BRANCH,   0, 10, 0, FLAG_P,          FLAGS_NONE, OP_JMP_IF(IF_PE))  \
+    X(0xEB, "XCHG", "",    OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_XCHG())         \
+    X(0xEC, "CPE",  "",    OPERAND_A16,  3, FLOW_CALL,     0, 11, 6, FLAG_P,          FLAGS_NONE, OP_CALL_IF(IF_PE)) \
+    X(0xED, "CALL", "",    OPERAND_A16,  3, FLOW_CALL,     1, 17, 0, FLAGS_NONE,      FLAGS_NONE, OP_CALL())         \
+    X(0xEE, "XRI",  "",    OPERAND_D8,   2, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_ALL,  OP_XRA(IMM8))      \
+    X(0xEF, "RST",  "5",   OPERAND_NONE, 1, FLOW_RST,      0, 11, 0, FLAGS_NONE,      FLAGS_NONE, OP_RST(5))         \
+    X(0xF0, "RP",   "",    OPERAND_NONE, 1, FLOW_RET_COND, 0, 5,  6, FLAG_S,          FLAGS_NONE, OP_RET_IF(IF_P))   \
+    X(0xF1, "POP",  "PSW", OPERAND_NONE, 1, FLOW_NEXT,     0, 10, 0, FLAGS_NONE,      FLAGS_ALL,  OP_POP_PSW())      \
+    X(0xF2, "JP",   "",    OPERAND_A16,  3, FLOW_BRANCH,   0, 10, 0, FLAG_S,          FLAGS_NONE, OP_JMP_IF(IF_P))   \
+    X(0xF3, "DI",   "",    OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_NONE, OP_DI())           \
+    X(0xF4, "CP",   "",    OPERAND_A16,  3, FLOW_CALL,     0, 11, 6, FLAG_S,          FLAGS_NONE, OP_CALL_IF(IF_P))  \
+    X(0xF5, "PUSH", "PSW", OPERAND_NONE, 1, FLOW_NEXT,     0, 11, 0, FLAGS_ALL,       FLAGS_NONE, OP_PUSH_PSW())     \
+    X(0xF6, "ORI",  "",    OPERAND_D8,   2, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_ALL,  OP_ORA(IMM8))      \
+    X(0xF7, "RST",  "6",   OPERAND_NONE, 1, FLOW_RST,      0, 11, 0, FLAGS_NONE,      FLAGS_NONE, OP_RST(6))         \
+    X(0xF8, "RM",   "",    OPERAND_NONE, 1, FLOW_RET_COND, 0, 5,  6, FLAG_S,          FLAGS_NONE, OP_RET_IF(IF_M))   \
+    X(0xF9, "SPHL", "",    OPERAND_NONE, 1, FLOW_NEXT,     0, 5,  0, FLAGS_NONE,      FLAGS_NONE, OP_SPHL())         \
+    X(0xFA, "JM",   "",    OPERAND_A16,  3, FLOW_BRANCH,   0, 10, 0, FLAG_S,          FLAGS_NONE, OP_JMP_IF(IF_M))   \
+    X(0xFB, "EI",   "",    OPERAND_NONE, 1, FLOW_NEXT,     0, 4,  0, FLAGS_NONE,      FLAGS_NONE, OP_EI())           \
+    X(0xFC, "CM",   "",    OPERAND_A16,  3, FLOW_CALL,     0, 11, 6, FLAG_S,          FLAGS_NONE, OP_CALL_IF(IF_M))  \
+    X(0xFD, "CALL", "",    OPERAND_A16,  3, FLOW_CALL,     1, 17, 0, FLAGS_NONE,      FLAGS_NONE, OP_CALL())         \
+    X(0xFE, "CPI",  "",    OPERAND_D8,   2, FLOW_NEXT,     0, 7,  0, FLAGS_NONE,      FLAGS_ALL,  OP_CMP(IMM8))      \
+    X(0xFF, "RST",  "7",   OPERAND_NONE, 1, FLOW_RST,      0, 11, 0, FLAGS_NONE,      FLAGS_NONE, OP_RST(7))
+
+typedef struct{
+    const char* mnemonic;
+    const char* operands;
+    uint8_t kind;           //enum operand_kind
+    uint8_t length;         //Instruction length in bytes
+    uint8_t flow;           //enum flow_kind
+    uint8_t undocumented;
+    uint8_t cycles;         //Cycles for the instruction, or for a condition not taken
+    uint8_t taken_cycles;   //Extra cycles when a conditional CALL/RET is taken
+    uint8_t flags_read;     //FLAG_* bits
+    uint8_t flags_written;
+} i8080_opcode_t;
+
+extern const i8080_opcode_t i8080_opcodes[256];
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef i8080_reference_H
+#define i8080_reference_H
+
+#include "i8080_cpu.h"
+
+//Reference implementation of i8080_emulator(), used by the differential fuzzer
+void i8080_reference_emulator(i8080* cpu);
+
+#endif
@@ -3,9 +3,21 @@
 void key_pressed(SDL_Keycode key, machine_t* machine){
     switch(key){
         case SDLK_q: machine->quit_status=1; break;
+        case SDLK_b:        //Break into the debugger
+            if(machine->debugger) debugger_request_stop(machine->debugger);
+            break;
+        case SDLK_t:        //Toggle execution tracing
+            machine->trace=machine->trace ? NULL : machine->trace_log;
+            break;
+        case SDLK_TAB:      //Toggle fast-forward
+            machine->fast_forward=!machine->fast_forward;
+            break;
+        case SDLK_h:        //Toggle the performance overlay
+            machine->show_hud=!machine->show_hud;
+            break;
         case SDLK_c: machine->port_in1|=(1<<0); break;
         case SDLK_2: machine->port_in1|=(1<<1); break;
-        case SDLK_RETURN: machine->port_in1=(1<<2); break;
+        case SDLK_RETURN: machine->port_in1|=(1<<2); break;
         case SDLK_SPACE:
             machine->port_in1|=(1<<4);
             machine->port_in2|=(1<<4);
@@ -41,10 +53,20 @@ void key_released(SDL_Keycode key, machine_t* machine){
     }
 }
 
+//Converts an SDL event timestamp (ms since SDL init) to the latency probe's clock
+static uint64_t event_time_us(uint32_t timestamp){
+    uint32_t age_ms=SDL_GetTicks()-timestamp;
+
+    return latency_now_us()-(uint64_t)age_ms * 1000;
+}
+
 void keyboard_handler(machine_t* machine){
     SDL_Event event;
 
     while(SDL_PollEvent(&event)){
+        uint8_t old_in1=machine->port_in1;
+        uint8_t old_in2=machine->port_in2;
+
         switch(event.type){
           case SDL_QUIT: machine->quit_status=1; break;
           case SDL_KEYDOWN: key_pressed(event.key.keysym.sym, machine); break;
@@ -53,5 +75,10 @@ void keyboard_handler(machine_t* machine){
                 machine->port_in1|=(1<<3);
                 break;
         }
+
+        //Only changes that the ROM can actually observe are measured
+        if(machine->latency && (old_in1!=machine->port_in1 || old_in2!=machine->port_in2)){
+            latency_input_event(machine->latency, event_time_us(event.key.timestamp));
+        }
     }
 }
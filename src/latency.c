@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "latency.h"
+
+uint64_t latency_now_us(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+latency_probe_t* latency_init(){
+    latency_probe_t* probe=calloc(1, sizeof(latency_probe_t));
+
+    probe->state=LATENCY_IDLE;
+
+    return probe;
+}
+
+void latency_destroy(latency_probe_t* probe){
+    free(probe);
+}
+
+void latency_input_event(latency_probe_t* probe, uint64_t event_us){
+    //Only one change is tracked at a time, the oldest pending one wins
+    if(probe->state!=LATENCY_IDLE || probe->num_samples==LATENCY_MAX_SAMPLES){
+        probe->skipped++;
+        return;
+    }
+
+    probe->event_us=event_us;
+    probe->state=LATENCY_WAIT_READ;
+}
+
+void latency_port_read(latency_probe_t* probe){
+    if(probe->state==LATENCY_WAIT_READ){
+        probe->read_us=latency_now_us();
+        probe->state=LATENCY_WAIT_PRESENT;
+    }
+}
+
+void latency_frame_presented(latency_probe_t* probe){
+    if(probe->state==LATENCY_WAIT_PRESENT){
+        uint64_t now=latency_now_us();
+
+        //The event timestamp comes from SDL's millisecond clock, so it may be slightly in the future
+        uint64_t event_us=(probe->event_us < probe->read_us) ? probe->event_us : probe->read_us;
+
+        probe->event_to_read[probe->num_samples]=probe->read_us-event_us;
+        probe->read_to_present[probe->num_samples]=now-probe->read_us;
+        probe->num_samples++;
+
+        probe->state=LATENCY_IDLE;
+    }
+}
+
+static int compare_u32(const void* a, const void* b){
+    uint32_t x=*(const uint32_t*)a;
+    uint32_t y=*(const uint32_t*)b;
+
+    return (x>y)-(x<y);
+}
+
+//Sorts the samples in place and prints their percentiles in milliseconds
+static void print_percentiles(const char* name, uint32_t* samples, int n){
+    qsort(samples, n, sizeof(uint32_t), compare_u32);
+
+    printf("  %-18s p50=%6.2f  p90=%6.2f  p99=%6.2f  max=%6.2f ms\n", name,
+           samples[n * 50 / 100] / 1000.0, samples[n * 90 / 100] / 1000.0,
+           samples[n * 99 / 100] / 1000.0, samples[n-1] / 1000.0);
+}
+
+void latency_report(latency_probe_t* probe){
+    int n=probe->num_samples;
+
+    printf("Input latency: %d samples (%d changes skipped while measuring)\n", n, probe->skipped);
+
+    if(n==0){
+        return;
+    }
+
+    uint32_t total[LATENCY_MAX_SAMPLES];
+    for(int i=0; i<n; i++){
+        total[i]=probe->event_to_read[i]+probe->read_to_present[i];
+    }
+
+    print_percentiles("event -> IN read", probe->event_to_read, n);
+    print_percentiles("IN read -> present", probe->read_to_present, n);
+    print_percentiles("event -> present", total, n);
+}
@@ -0,0 +1,43 @@
+#ifndef latency_H
+#define latency_H
+
+#include <stdint.h>
+
+#define LATENCY_MAX_SAMPLES		4096
+
+enum latency_state{LATENCY_IDLE, LATENCY_WAIT_READ, LATENCY_WAIT_PRESENT};
+
+typedef struct{
+    int state;
+
+    uint64_t event_us;      //Host timestamp of the input change being measured
+    uint64_t read_us;       //Host time the ROM first read the changed port
+
+    //Samples in microseconds, one pair per measured input change
+    uint32_t event_to_read[LATENCY_MAX_SAMPLES];
+    uint32_t read_to_present[LATENCY_MAX_SAMPLES];
+    int num_samples;
+
+    int skipped;            //Input changes that arrived while a measurement was in flight
+} latency_probe_t;
+
+//Current host time in microseconds (monotonic clock)
+uint64_t latency_now_us();
+
+latency_probe_t* latency_init();
+
+void latency_destroy(latency_probe_t* probe);
+
+//An input change happened on the host at event_us
+void latency_input_event(latency_probe_t* probe, uint64_t event_us);
+
+//The emulated program read an input port
+void latency_port_read(latency_probe_t* probe);
+
+//A frame has been presented on the host display
+void latency_frame_presented(latency_probe_t* probe);
+
+//Prints p50/p90/p99/max of both latency stages
+void latency_report(latency_probe_t* probe);
+
+#endif
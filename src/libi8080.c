@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libi8080.h"
+#include "machine.h"
+#include "rom.h"
+
+//The public constants are spelled out so libi8080.h stays self-contained
+_Static_assert(LIBI8080_MEM_SIZE==MACHINE_MEM_SIZE, "libi8080.h is out of date");
+_Static_assert(LIBI8080_CYCLES_PER_FRAME==CYCLES_PER_FRAME, "libi8080.h is out of date");
+
+struct libi8080{
+    machine_t* machine;
+    char error[ROM_PATH_MAX+128];
+};
+
+int libi8080_version(void){
+    return LIBI8080_VERSION;
+}
+
+libi8080_t* libi8080_create(void){
+    libi8080_t* handle=calloc(1, sizeof(libi8080_t));
+
+    if(!handle){
+        return NULL;
+    }
+
+    handle->machine=init_machine();
+
+    if(!handle->machine){
+        free(handle);
+        return NULL;
+    }
+
+    return handle;
+}
+
+void libi8080_destroy(libi8080_t* handle){
+    destroy_machine(handle->machine);
+    free(handle);
+}
+
+int libi8080_load_rom(libi8080_t* handle, const char* rom_dir){
+    char rom_path[ROM_PATH_MAX]="";
+
+    handle->error[0]='\0';
+
+#ifndef EMBED_ROMS
+    if(rom_find_dir(rom_dir, rom_path, sizeof(rom_path))<0){
+        snprintf(handle->error, sizeof(handle->error), "Cannot find the ROM directory");
+        return -1;
+    }
+#else
+    (void)rom_dir;      //The ROMs are compiled into the library
+#endif
+
+    return rom_load_set(&invaders_rom_set, rom_path, handle->machine->machine_mem, MACHINE_MEM_SIZE,
+                        handle->error, sizeof(handle->error));
+}
+
+const char* libi8080_error(libi8080_t* handle){
+    return handle->error;
+}
+
+int libi8080_run_cycles(libi8080_t* handle, int cycles){
+    //machine_run_until() stops once the count passes its target, so aim one cycle short
+    return machine_run_until(handle->machine, 0, cycles-1);
+}
+
+void libi8080_run_frame(libi8080_t* handle){
+    machine_run_frame(handle->machine);
+}
+
+void libi8080_interrupt(libi8080_t* handle, int num){
+    generate_interrupt(handle->machine, num);
+}
+
+int libi8080_set_port(libi8080_t* handle, int port, uint8_t value){
+    switch(port){
+        case 1: handle->machine->port_in1=value; return 0;
+        case 2: handle->machine->port_in2=value; return 0;
+    }
+
+    return -1;
+}
+
+uint8_t libi8080_read(libi8080_t* handle, uint16_t addr){
+    return handle->machine->machine_mem[addr & (MACHINE_MEM_SIZE-1)];
+}
+
+void libi8080_write(libi8080_t* handle, uint16_t addr, uint8_t value){
+    handle->machine->machine_mem[addr & (MACHINE_MEM_SIZE-1)]=value;
+}
+
+size_t libi8080_state_size(void){
+    return MACHINE_STATE_SIZE;
+}
+
+int libi8080_save_state(libi8080_t* handle, void* buffer, size_t size){
+    if(size<MACHINE_STATE_SIZE){
+        return -1;
+    }
+
+    machine_save_state(handle->machine, buffer);
+
+    return 0;
+}
+
+int libi8080_load_state(libi8080_t* handle, const void* buffer, size_t size){
+    return machine_load_state(handle->machine, buffer, size);
+}
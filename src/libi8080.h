@@ -0,0 +1,73 @@
+#ifndef libi8080_H
+#define libi8080_H
+
+/*Embeddable Space Invaders machine, built as lib/libi8080.so and lib/libi8080.a by
+"make lib". This header is the whole public API: it needs nothing beyond the C
+library and never exposes the emulator's internal structs, so programs built
+against it keep working when those change.
+
+A typical harness:
+    libi8080_t* m=libi8080_create();
+    libi8080_load_rom(m, "ROM");
+    for(;;){ libi8080_set_port(m, 1, inputs); libi8080_run_frame(m); ... }
+    libi8080_destroy(m);*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LIBI8080_API		__attribute__((visibility("default")))
+
+#define LIBI8080_VERSION	1
+#define LIBI8080_MEM_SIZE	0x4000		//Address space, A14 and A15 are not decoded
+#define LIBI8080_CYCLES_PER_FRAME	(2000000 / 60)
+
+typedef struct libi8080 libi8080_t;
+
+//Returns the LIBI8080_VERSION the library was built with
+LIBI8080_API int libi8080_version(void);
+
+//Returns NULL if out of memory
+LIBI8080_API libi8080_t* libi8080_create(void);
+
+LIBI8080_API void libi8080_destroy(libi8080_t* machine);
+
+/*Loads and verifies the Space Invaders ROM set from rom_dir (NULL searches ./ROM and
+ROM next to the executable). Returns -1 if it is missing or corrupt, see
+libi8080_error()*/
+LIBI8080_API int libi8080_load_rom(libi8080_t* machine, const char* rom_dir);
+
+//Describes the last failure, empty if there was none
+LIBI8080_API const char* libi8080_error(libi8080_t* machine);
+
+//Runs whole instructions until at least cycles have passed, returns the cycles run
+LIBI8080_API int libi8080_run_cycles(libi8080_t* machine, int cycles);
+
+//Runs one 60 Hz frame, including the mid-screen and end-of-screen interrupts
+LIBI8080_API void libi8080_run_frame(libi8080_t* machine);
+
+//Raises RST num if interrupts are enabled
+LIBI8080_API void libi8080_interrupt(libi8080_t* machine, int num);
+
+//Sets input port 1 or 2 (see the README for the bits), returns -1 for other ports
+LIBI8080_API int libi8080_set_port(libi8080_t* machine, int port, uint8_t value);
+
+//Addresses wrap at LIBI8080_MEM_SIZE. Writes reach the ROM too, for patching
+LIBI8080_API uint8_t libi8080_read(libi8080_t* machine, uint16_t addr);
+LIBI8080_API void libi8080_write(libi8080_t* machine, uint16_t addr, uint8_t value);
+
+//Bytes needed by libi8080_save_state()
+LIBI8080_API size_t libi8080_state_size(void);
+
+//Both return -1 if size is too small, or the state is not from this library version
+LIBI8080_API int libi8080_save_state(libi8080_t* machine, void* buffer, size_t size);
+LIBI8080_API int libi8080_load_state(libi8080_t* machine, const void* buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
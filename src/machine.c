@@ -1,17 +1,43 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "machine.h"
 #include "i8080_cpu.h"
+#include "rom.h"
+#include "profiler.h"
+
+#define WHITE	{255, 255, 255}
+#define RED	{204, 0, 0}
+#define GREEN	{0, 204, 0}
+
+const uint8_t overlay_colors[SCREEN_HEIGHT / 8][3]={
+    WHITE,                              //Top row
+    WHITE, WHITE, WHITE,                //Scoreboard is in black and white
+    RED, RED, RED, RED,                 //Right underneath the scoreboard, pixels landed there would be in red
+    WHITE, WHITE, WHITE, WHITE, WHITE, WHITE, WHITE, WHITE,
+    WHITE, WHITE, WHITE, WHITE, WHITE, WHITE, WHITE, WHITE,
+    GREEN, GREEN, GREEN, GREEN,         //Bottom portion of the screen is in green
+    GREEN, GREEN, GREEN, GREEN
+};
 
 machine_t* init_machine(){
-    machine_t* machine=calloc(1, sizeof(machine_t));
+    machine_t* machine=aligned_alloc(_Alignof(machine_t), sizeof(machine_t));
 
-    //Allocate space for the machine memory
-    machine->machine_mem=malloc(sizeof(uint8_t) * 0x4000);
+    if(!machine){
+        return NULL;
+    }
 
-    //Initiate an i8080 CPU
-    machine->cpu=i8080_init();
+    memset(machine, 0, sizeof(machine_t));
+
+    //Initiate the i8080 CPU and point it at the machine memory
+    machine->cpu=&machine->cpu_state;
+    machine->machine_mem=machine->memory;
+    i8080_reset(machine->cpu);
 
-    //Set the cpu's memory reference to the allocated memory space of the machine
     machine->cpu->memory=machine->machine_mem;
+    machine->cpu->address_mask=MACHINE_MEM_SIZE-1;      //Only A0-A13 are decoded
+    machine->cpu->rom_size=MACHINE_ROM_SIZE;      //0x0000->0x1FFF is ROM
 
     machine->int_num=1;     //Interrupt number is resetted to 1
     machine->port_in1=(1<<3);     //Bit 3 always set
@@ -19,49 +45,51 @@ machine_t* init_machine(){
     machine->shift0=0;
     machine->shift1=0;
     machine->shift_offset=0;
+    machine->screen=NULL;
     machine->quit_status=0;       //Just started, so no quit yet
-
-    //Clear the screen buffer upon reset
-    memset(machine->screen_buffer, 0, sizeof(machine->screen_buffer));
+    machine->fast_forward=0;
+    machine->show_hud=0;
+    memset(&machine->counters, 0, sizeof(machine_counters_t));
+    machine->latency=NULL;
+    machine->trace=NULL;
+    machine->trace_log=NULL;
+    machine->debugger=NULL;
+    machine->profiler=NULL;
+    machine->recorder=NULL;
+    machine->input_log=NULL;
 
     return machine;
 }
 
+void machine_attach_screen(machine_t* machine){
+    if(!machine->screen){
+        //Starts out black and not matching any VRAM
+        machine->screen=calloc(1, sizeof(machine_screen_t));
+    }
+}
+
 void destroy_machine(machine_t* machine){
-    free(machine->cpu);
-    free(machine->machine_mem);
+    free(machine->screen);
     free(machine);
 }
 
-void load_file_into_mem(machine_t* machine, char* file_path, uint16_t offset){
-    //Open the file in binary read mode
-    FILE* fp=fopen(file_path, "rb");
+int load_game(machine_t* machine, const char* rom_dir){
+    char error[ROM_PATH_MAX+128];
 
-    if(!fp){      //Test if file exists
-        printf("File doesn't exist!\n");
-        exit(1);
+    //Loads all the ROM files of space invaders
+    if(rom_load_set(&invaders_rom_set, rom_dir, machine->machine_mem, MACHINE_MEM_SIZE, error, sizeof(error))<0){
+        printf("Cannot load ROM set: %s\n", error);
+        return -1;
     }
 
-    //Get file size
-    fseek(fp, 0, SEEK_END);
-    int f_size=ftell(fp);
-    fseek(fp, 0, SEEK_SET);
-
-    //Read file into machine memory
-    fread(&machine->machine_mem[offset], f_size, 1, fp);
-
-    fclose(fp);
-}
-
-void load_game(machine_t* machine){
-    //Loads all the ROM files of space invaders
-    load_file_into_mem(machine, "ROM/invaders.h", 0x0000);
-    load_file_into_mem(machine, "ROM/invaders.g", 0x0800);
-    load_file_into_mem(machine, "ROM/invaders.f", 0x1000);
-    load_file_into_mem(machine, "ROM/invaders.e", 0x1800);
+    return 0;
 }
 
 void machine_execute(machine_t* machine){
+    if(machine->trace){
+        trace_instruction(machine->trace, machine->cpu);
+    }
+
     uint8_t opcode=read_mem(machine->cpu, machine->cpu->PC);
 
     if(opcode==0xD3){     //OUT   d8
@@ -83,8 +111,14 @@ void machine_execute(machine_t* machine){
 
         switch(port){
             uint16_t val;
-            case 1: machine->cpu->A=machine->port_in1; break;
-            case 2: machine->cpu->A=machine->port_in2; break;
+            case 1:
+                machine->cpu->A=machine->port_in1;
+                if(machine->latency) latency_port_read(machine->latency);
+                break;
+            case 2:
+                machine->cpu->A=machine->port_in2;
+                if(machine->latency) latency_port_read(machine->latency);
+                break;
             case 3:
                 val=(machine->shift1<<8)|(machine->shift0);
                 machine->cpu->A=(val>>(8-machine->shift_offset)) & 0xFF;
@@ -98,71 +132,282 @@ void machine_execute(machine_t* machine){
     }
 }
 
+//Executes one instruction and charges it to the profiler's current call path
+static void machine_execute_profiled(machine_t* machine){
+    i8080* cpu=machine->cpu;
+    uint16_t pc=cpu->PC;
+    uint16_t sp=cpu->SP;
+    uint8_t opcode=cpu->memory[pc & cpu->address_mask];
+    int cycles=cpu->instruction_cycles;
+
+    machine_execute(machine);
+    profiler_step(machine->profiler, pc, opcode, sp, cpu, cpu->instruction_cycles-cycles);
+}
+
+//Same as machine_run_until(), but asks the debugger before every instruction
+static int machine_run_until_checked(machine_t* machine, int frame_cycles, int target_cycles){
+    int current_cycle=0;
+    int start_cycles=frame_cycles;
+    uint64_t instructions=0;
+
+    while(frame_cycles<=target_cycles){
+        if(debugger_check(machine->debugger, machine->cpu)){
+            debugger_stopped(machine->debugger, machine->cpu);
+
+            if(machine->debugger->quit){
+                machine->quit_status=1;
+                break;
+            }
+
+            //Check again so the resumed instruction is seen by step out and watchpoints
+            continue;
+        }
+
+        current_cycle=machine->cpu->instruction_cycles;
+        if(machine->profiler){
+            machine_execute_profiled(machine);
+        }
+        else{
+            machine_execute(machine);
+        }
+        frame_cycles+=machine->cpu->instruction_cycles-current_cycle;
+        instructions++;
+    }
+
+    machine->counters.instructions+=instructions;
+    machine->counters.cycles+=frame_cycles-start_cycles;
+
+    return frame_cycles;
+}
+
+//Same as machine_run_until(), with every instruction accounted by the profiler
+static int machine_run_until_profiled(machine_t* machine, int frame_cycles, int target_cycles){
+    int current_cycle=0;
+    int start_cycles=frame_cycles;
+    uint64_t instructions=0;
+
+    while(frame_cycles<=target_cycles){
+        current_cycle=machine->cpu->instruction_cycles;
+        machine_execute_profiled(machine);
+        frame_cycles+=machine->cpu->instruction_cycles-current_cycle;
+        instructions++;
+    }
+
+    machine->counters.instructions+=instructions;
+    machine->counters.cycles+=frame_cycles-start_cycles;
+
+    return frame_cycles;
+}
+
+int machine_run_until(machine_t* machine, int frame_cycles, int target_cycles){
+    //Breakpoints, watchpoints and stepping cost nothing unless the debugger has something to check
+    if(machine->debugger && machine->debugger->armed){
+        return machine_run_until_checked(machine, frame_cycles, target_cycles);
+    }
+
+    if(machine->profiler){
+        return machine_run_until_profiled(machine, frame_cycles, target_cycles);
+    }
+
+    int current_cycle=0;    /*machine->cpu->instruction_cycles-current_cycle
+                              would give the CPU cycles after executing an instruction*/
+    int start_cycles=frame_cycles;
+    uint64_t instructions=0;    //Counted in a register, the counters are updated once per call
+
+    while(frame_cycles<=target_cycles){
+        current_cycle=machine->cpu->instruction_cycles;
+        machine_execute(machine);
+        frame_cycles+=machine->cpu->instruction_cycles-current_cycle;
+        instructions++;
+    }
+
+    machine->counters.instructions+=instructions;
+    machine->counters.cycles+=frame_cycles-start_cycles;
+
+    return frame_cycles;
+}
+
+void machine_run_frame(machine_t* machine){
+    int frame_cycles=machine_run_until(machine, 0, HALF_CYCLES_PER_FRAME);
+    generate_interrupt(machine, 1);
+
+    machine_run_until(machine, frame_cycles, CYCLES_PER_FRAME);
+    generate_interrupt(machine, 2);
+}
+
+void machine_copy_state(machine_t* dst, const machine_t* src){
+    uint8_t* memory=dst->cpu->memory;
+
+    *dst->cpu=*src->cpu;
+    dst->cpu->memory=memory;
+    memcpy(dst->machine_mem, src->machine_mem, MACHINE_MEM_SIZE);
+
+    dst->port_in1=src->port_in1;
+    dst->port_in2=src->port_in2;
+    dst->shift0=src->shift0;
+    dst->shift1=src->shift1;
+    dst->shift_offset=src->shift_offset;
+    dst->int_num=src->int_num;
+}
+
+void machine_snapshot(const machine_t* machine, machine_snapshot_t* snapshot){
+    snapshot->cpu=*machine->cpu;
+    memcpy(snapshot->ram, machine->machine_mem+MACHINE_ROM_SIZE, sizeof(snapshot->ram));
+
+    snapshot->port_in1=machine->port_in1;
+    snapshot->port_in2=machine->port_in2;
+    snapshot->shift0=machine->shift0;
+    snapshot->shift1=machine->shift1;
+    snapshot->shift_offset=machine->shift_offset;
+    snapshot->int_num=machine->int_num;
+}
+
+void machine_restore(machine_t* machine, const machine_snapshot_t* snapshot){
+    *machine->cpu=snapshot->cpu;
+    memcpy(machine->machine_mem+MACHINE_ROM_SIZE, snapshot->ram, sizeof(snapshot->ram));
+
+    machine->port_in1=snapshot->port_in1;
+    machine->port_in2=snapshot->port_in2;
+    machine->shift0=snapshot->shift0;
+    machine->shift1=snapshot->shift1;
+    machine->shift_offset=snapshot->shift_offset;
+    machine->int_num=snapshot->int_num;
+}
+
+static uint8_t* put16(uint8_t* out, uint16_t value){
+    out[0]=value & 0xFF;
+    out[1]=value>>8;
+    return out+2;
+}
+
+static uint16_t get16(const uint8_t* in){
+    return in[0] | (in[1]<<8);
+}
+
+void machine_save_state(machine_t* machine, uint8_t* out){
+    i8080* cpu=machine->cpu;
+    uint8_t* p=out;
+
+    memset(out, 0, MACHINE_STATE_HEADER);
+    memcpy(p, MACHINE_STATE_MAGIC, 4);
+    p+=4;
+    p=put16(p, MACHINE_STATE_VERSION);
+    p=put16(p, cpu->PC);
+    p=put16(p, cpu->SP);
+    p=put16(p, cpu->BC);
+    p=put16(p, cpu->DE);
+    p=put16(p, cpu->HL);
+    *p++=cpu->A;
+    *p++=i8080_get_psw(cpu);
+    p=put16(p, cpu->instruction_cycles & 0xFFFF);
+    p=put16(p, (uint32_t)cpu->instruction_cycles>>16);
+    *p++=cpu->interrupt_enable;
+    *p++=machine->port_in1;
+    *p++=machine->port_in2;
+    *p++=machine->shift0;
+    *p++=machine->shift1;
+    *p++=machine->shift_offset;
+    *p++=machine->int_num;
+
+    memcpy(out+MACHINE_STATE_HEADER, machine->machine_mem, MACHINE_MEM_SIZE);
+}
+
+int machine_load_state(machine_t* machine, const uint8_t* in, size_t size){
+    if(size<MACHINE_STATE_SIZE || memcmp(in, MACHINE_STATE_MAGIC, 4)!=0 ||
+       get16(in+4)!=MACHINE_STATE_VERSION){
+        return -1;
+    }
+
+    i8080* cpu=machine->cpu;
+    const uint8_t* p=in+6;
+
+    cpu->PC=get16(p);
+    cpu->SP=get16(p+2);
+    cpu->BC=get16(p+4);
+    cpu->DE=get16(p+6);
+    cpu->HL=get16(p+8);
+    cpu->A=p[10];
+    i8080_set_psw(cpu, p[11]);
+    cpu->instruction_cycles=(int)(get16(p+12) | ((uint32_t)get16(p+14)<<16));
+    cpu->interrupt_enable=p[16];
+    machine->port_in1=p[17];
+    machine->port_in2=p[18];
+    machine->shift0=p[19];
+    machine->shift1=p[20];
+    machine->shift_offset=p[21];
+    machine->int_num=p[22];
+
+    memcpy(machine->machine_mem, in+MACHINE_STATE_HEADER, MACHINE_MEM_SIZE);
+
+    return 0;
+}
+
 void machine_update_screen(machine_t* machine){
     for(int x=0; x<SCREEN_WIDTH; x++){
+        machine_update_scanline(machine, x);
+    }
+}
+
+int machine_refresh_screen(machine_t* machine){
+    const uint8_t* vram=machine->machine_mem+VRAM_START;
+
+    //Comparing 7K is far cheaper than converting 57K pixels and uploading them again
+    if(machine->screen->valid && memcmp(machine->screen->vram_shadow, vram, VRAM_SIZE)==0){
+        return 0;
+    }
+
+    machine_update_screen(machine);
+    memcpy(machine->screen->vram_shadow, vram, VRAM_SIZE);
+    machine->screen->valid=1;
+
+    return 1;
+}
+
+void machine_update_scanline(machine_t* machine, int line){
+    uint16_t offset=0x241F+(line * 0x20);
+
+    for(int y=0; y<SCREEN_HEIGHT; y+=8){
+
+        uint8_t data_byte=machine->machine_mem[offset];
+        const uint8_t* color=overlay_colors[y / 8];
+
+        for(int bit=0; bit<8; bit++){
+            uint8_t* pixel=machine->screen->pixels[y+bit][line];
 
-        uint16_t offset=0x241F+(x * 0x20);
-
-        for(int y=0; y<SCREEN_HEIGHT; y+=8){
-
-            uint8_t data_byte=machine->machine_mem[offset];
-
-            for(int bit=0; bit<8; bit++){
-                
-                if(y>0 && y<=30){       //Scoreboard is in black and white
-                    if((data_byte<<bit) & 0x80){
-                        machine->screen_buffer[y+bit][x][R]=255;
-                        machine->screen_buffer[y+bit][x][G]=255;
-                        machine->screen_buffer[y+bit][x][B]=255;
-                    }
-                    else{
-                        machine->screen_buffer[y+bit][x][R]=0;
-                        machine->screen_buffer[y+bit][x][G]=0;
-                        machine->screen_buffer[y+bit][x][B]=0;
-                    }
-                }
-                else if(y>31 && y<60){      //Right underneath the scoreboard, pixels landed there would be in red
-                    if((data_byte<<bit) & 0x80){
-                        machine->screen_buffer[y+bit][x][R]=204;
-                        machine->screen_buffer[y+bit][x][G]=0;
-                        machine->screen_buffer[y+bit][x][B]=0;
-                    }
-                    else{
-                        machine->screen_buffer[y+bit][x][R]=0;
-                        machine->screen_buffer[y+bit][x][G]=0;
-                        machine->screen_buffer[y+bit][x][B]=0;
-                    }
-                }
-                else if(y>=192){       //Bottom portion of the screen is in green
-                    if((data_byte<<bit) & 0x80){
-                        machine->screen_buffer[y+bit][x][R]=0;
-                        machine->screen_buffer[y+bit][x][G]=204;
-                        machine->screen_buffer[y+bit][x][B]=0;
-                    }
-                    else{
-                        machine->screen_buffer[y+bit][x][R]=0;
-                        machine->screen_buffer[y+bit][x][G]=0;
-                        machine->screen_buffer[y+bit][x][B]=0;
-                    }
-                }
-                else{       //Everything else is black and white
-                    if((data_byte<<bit) & 0x80){
-                        machine->screen_buffer[y+bit][x][R]=255;
-                        machine->screen_buffer[y+bit][x][G]=255;
-                        machine->screen_buffer[y+bit][x][B]=255;
-                    }
-                    else{
-                        machine->screen_buffer[y+bit][x][R]=0;
-                        machine->screen_buffer[y+bit][x][G]=0;
-                        machine->screen_buffer[y+bit][x][B]=0;
-                    }
-                }
+            if((data_byte<<bit) & 0x80){
+                pixel[R]=color[R];
+                pixel[G]=color[G];
+                pixel[B]=color[B];
+            }
+            else{
+                pixel[R]=0;
+                pixel[G]=0;
+                pixel[B]=0;
             }
-            offset--;
         }
+        offset--;
     }
 }
 
+int machine_race_beam(machine_t* machine, int frame_cycles, int target_cycles, int* next_line){
+    //The screen buffer now mixes VRAM from different points in the frame
+    machine->screen->valid=0;
+
+    while(*next_line<SCREEN_WIDTH){
+        int line_end=(VBLANK_SCANLINES + *next_line + 1) * CYCLES_PER_SCANLINE;
+
+        if(line_end>target_cycles){
+            break;
+        }
+
+        frame_cycles=machine_run_until(machine, frame_cycles, line_end);
+        machine_update_scanline(machine, *next_line);
+        (*next_line)++;
+    }
+
+    return machine_run_until(machine, frame_cycles, target_cycles);
+}
+
 void generate_interrupt(machine_t* machine, uint8_t int_num){
     //Only generate interrupt if interrupt-enable is set
     if(machine->cpu->interrupt_enable==1){
@@ -172,5 +417,15 @@ void generate_interrupt(machine_t* machine, uint8_t int_num){
         RST(machine->cpu, int_num);
         //11 cycles taken for interrupts
         machine->cpu->instruction_cycles+=11;
+
+        machine->counters.interrupts++;
+        machine->counters.cycles+=11;
+
+        if(machine->profiler){
+            profiler_interrupt(machine->profiler, machine->cpu->PC, machine->cpu->SP, 11);
+        }
+    }
+    else{
+        machine->counters.interrupts_dropped++;
     }
 }
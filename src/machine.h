@@ -2,9 +2,9 @@
 #define machine_H
 
 #include "i8080_cpu.h"
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
+#include "latency.h"
+#include "trace.h"
+#include "debugger.h"
 
 #define SCREEN_WIDTH 			224
 #define SCREEN_HEIGHT			256
@@ -13,33 +13,148 @@
 #define CYCLES_PER_FRAME		CLOCK_RATE / FPS	//2x10^6 cpu per second.
 #define HALF_CYCLES_PER_FRAME	 	CYCLES_PER_FRAME / 2		//Used to trigger interrupts
 
+/*Video timing used by the beam-racing renderer. A frame starts at the end-of-screen
+interrupt (start of vertical blank), so visible scanline n finishes at
+(VBLANK_SCANLINES + n + 1) * CYCLES_PER_SCANLINE cycles into the frame. This puts the
+mid-screen interrupt at scanline ~93, close to the real hardware's scanline 96.
+Scanlines run along VRAM rows, which become screen columns on the rotated monitor*/
+#define SCANLINES_PER_FRAME		262
+#define VBLANK_SCANLINES		(SCANLINES_PER_FRAME - SCREEN_WIDTH)
+#define CYCLES_PER_SCANLINE		(CYCLES_PER_FRAME / SCANLINES_PER_FRAME)
+
+#define MACHINE_MEM_SIZE		0x4000		//8K ROM + 1K RAM + 7K VRAM
+#define MACHINE_ROM_SIZE		0x2000
+#define VRAM_START			0x2400
+#define VRAM_SIZE			0x1C00
+
 enum colors{R, G, B};
 
+struct recorder;		//recorder.h and replay.h need the constants above
+struct replay;
+struct profiler;
+
+//Colour of the cabinet overlay for each band of 8 screen rows
+extern const uint8_t overlay_colors[SCREEN_HEIGHT / 8][3];
+
+//RGB framebuffer, only allocated for machines that are displayed
 typedef struct{
+    uint8_t pixels[SCREEN_HEIGHT][SCREEN_WIDTH][3];
+    uint8_t vram_shadow[VRAM_SIZE];	//VRAM as of the last conversion into pixels
+    int valid;			//pixels matches vram_shadow
+} machine_screen_t;
+
+/*Running totals kept by the machine itself. Only the thread driving the machine
+updates them, so they are plain integers that cost an add each; readers on that same
+thread (such as the metrics sink) take differences between samples*/
+typedef struct{
+    uint64_t instructions;
+    uint64_t cycles;
+    uint64_t interrupts;		//Interrupts taken by the CPU
+    uint64_t interrupts_dropped;	//Interrupts lost in generate_interrupt() because IE was clear
+} machine_counters_t;
+
+/*The CPU and the address space live inside the machine, so a headless machine is
+one allocation of about 17K. cpu and machine_mem point at them*/
+typedef struct{
+    i8080 cpu_state;
+    uint8_t memory[MACHINE_MEM_SIZE];
+
     i8080* cpu;     //Pointer to i8080 cpu
+    uint8_t* machine_mem;	//Pointer to the machine memory
     uint8_t port_in1, port_in2;
     uint8_t shift0, shift1, shift_offset;
 
-    uint8_t screen_buffer[SCREEN_HEIGHT][SCREEN_WIDTH][3];
-    uint8_t* machine_mem;	//Pointer to allocated memory
-
     uint8_t int_num;
 
+    machine_screen_t* screen;	//NULL until machine_attach_screen()
+
+    machine_counters_t counters;
+
     int quit_status;
+    int fast_forward;		//Skip rendering of frames nobody can see, toggled with Tab
+    int show_hud;		//Draw the performance overlay, toggled with H
+
+    latency_probe_t* latency;	//Input latency probe, NULL when disabled
+
+    trace_t* trace;		//Active execution trace, NULL when tracing is off
+    trace_t* trace_log;		//Trace file opened for this run, toggled into trace at runtime
+
+    debugger_t* debugger;	//NULL when debugging is not available
+    struct profiler* profiler;	//Guest call-graph profiler, NULL when not profiling
+
+    struct recorder* recorder;	//Gameplay recording, NULL when not recording
+    struct replay* input_log;	//Input recording for replays, NULL when not recording
 } machine_t;
 
+//Creates a headless machine, see machine_attach_screen(). Returns NULL if out of memory
 machine_t* init_machine();
 
 void destroy_machine(machine_t* machine);
 
-void load_file_into_mem(machine_t* machine, char* file_path, uint16_t offset);
-
-void load_game(machine_t* machine);
+/*Loads and verifies the Space Invaders ROM set from rom_dir (ignored when the ROMs are
+embedded). Prints what is wrong and returns -1 if the set is missing or corrupt*/
+int load_game(machine_t* machine, const char* rom_dir);
 
 void machine_execute(machine_t* machine);
 
+//Executes instructions until the frame's cycle count reaches target_cycles,
+//returns the updated frame cycle count
+int machine_run_until(machine_t* machine, int frame_cycles, int target_cycles);
+
+//Runs one frame with the current inputs: both halves and their interrupts
+void machine_run_frame(machine_t* machine);
+
+//Copies the CPU, memory and I/O state of src into dst, leaving the screen and
+//everything attached to dst (trace, debugger, ...) alone
+void machine_copy_state(machine_t* dst, const machine_t* src);
+
+/*In-memory snapshot for rolling a machine back within a session (run-ahead, rollback).
+The ROM cannot be written by the CPU, so only the CPU, RAM and I/O latches are kept,
+which makes taking or restoring one a copy of about 8K. The counters are not part of
+it: they keep counting work done*/
+typedef struct{
+    i8080 cpu;
+    uint8_t ram[MACHINE_MEM_SIZE - MACHINE_ROM_SIZE];
+    uint8_t port_in1, port_in2;
+    uint8_t shift0, shift1, shift_offset;
+    uint8_t int_num;
+} machine_snapshot_t;
+
+void machine_snapshot(const machine_t* machine, machine_snapshot_t* snapshot);
+
+//Only for snapshots of the same machine
+void machine_restore(machine_t* machine, const machine_snapshot_t* snapshot);
+
+/*Serialized machine state: a MACHINE_STATE_HEADER byte header with the magic, version,
+CPU registers and I/O latches in little-endian order, followed by the whole address
+space. The layout only changes together with MACHINE_STATE_VERSION*/
+#define MACHINE_STATE_MAGIC		"I80S"
+#define MACHINE_STATE_VERSION		1
+#define MACHINE_STATE_HEADER		32
+#define MACHINE_STATE_SIZE		(MACHINE_STATE_HEADER + MACHINE_MEM_SIZE)
+
+//Writes MACHINE_STATE_SIZE bytes to out
+void machine_save_state(machine_t* machine, uint8_t* out);
+
+//Returns -1, leaving the machine untouched, if in is not a state of this version
+int machine_load_state(machine_t* machine, const uint8_t* in, size_t size);
+
+//Gives the machine an RGB framebuffer, needed by the screen conversion functions below
+void machine_attach_screen(machine_t* machine);
+
 void machine_update_screen(machine_t* machine);
 
+//Converts VRAM into the screen buffer only if it changed since the last conversion,
+//returns 1 if the screen buffer was updated
+int machine_refresh_screen(machine_t* machine);
+
+//Converts one scanline of VRAM (one screen column) into the screen buffer
+void machine_update_scanline(machine_t* machine, int line);
+
+//Like machine_run_until(), but converts every scanline the emulated beam finishes
+//on the way; *next_line is the next scanline still to be converted
+int machine_race_beam(machine_t* machine, int frame_cycles, int target_cycles, int* next_line);
+
 void generate_interrupt(machine_t* machine, uint8_t int_num);
 
 #endif
@@ -6,15 +6,401 @@
 #include "machine.h"
 #include "input.h"
 #include "graphics.h"
+#include "rom.h"
+#include "recorder.h"
+#include "hud.h"
+#include "metrics.h"
+#include "replay.h"
+#include "profiler.h"
+#include "netplay.h"
 
-int main(){
-    display_t* game_display=malloc(sizeof(display_t));
-    init_SDL(game_display);
+#define BEAM_SLICE_LINES		32		//Scanlines pushed to the display at once when beam racing
+#define FAST_FORWARD_SPEED		8		//Default speed multiplier for Tab
+#define FAST_FORWARD_BUDGET		0.8f		//Share of a display frame spent emulating at unlimited speed
+#define RUN_AHEAD_MAX			6		//Frames of run-ahead allowed by --run-ahead
+
+//Reads the keyboard, and logs the result when recording a replay
+static void sample_input(machine_t* machine){
+    keyboard_handler(machine);
+
+    if(machine->input_log){
+        replay_record(machine->input_log, machine->port_in1, machine->port_in2);
+    }
+}
+
+//Runs both halves of a frame, sampling input at each interrupt boundary
+static void run_frame(machine_t* machine){
+    int total_cycles=0;   //Total number of instruction cycles
+
+    //Input is sampled at each interrupt boundary, so the ROM sees a key press within half a frame
+    sample_input(machine);
+    total_cycles=machine_run_until(machine, total_cycles, HALF_CYCLES_PER_FRAME);
+    //Generate mid-screen interrupt (interrupt number = 1)
+    generate_interrupt(machine, 1);
+
+    sample_input(machine);
+    total_cycles=machine_run_until(machine, total_cycles, CYCLES_PER_FRAME);
+    //Generate end-of-screen interrupt (interrupt number = 2)
+    generate_interrupt(machine, 2);
+
+    if(machine->recorder){
+        recorder_frame(machine->recorder, machine->machine_mem+VRAM_START);
+    }
+}
+
+/*Runs a frame converting each scanline as the emulated beam passes it, the way the
+real monitor scans VRAM. Finished slices are uploaded right away, so the frame can be
+presented as soon as this returns*/
+static void run_frame_beam_racing(machine_t* machine, display_t* display){
+    int total_cycles=0;
+    int next_line=0;      //Next scanline to be converted
+    int pushed=0;         //Scanlines already uploaded to the display
+
+    for(int int_num=1; int_num<=2; int_num++){
+        int int_cycles=(int_num==1) ? HALF_CYCLES_PER_FRAME : CYCLES_PER_FRAME;
+
+        sample_input(machine);
+
+        while(total_cycles<=int_cycles){
+            //Stop at the end of the next slice, or at the interrupt if it comes first
+            int target=int_cycles;
+            if(next_line<SCREEN_WIDTH){
+                int slice_end=pushed+BEAM_SLICE_LINES;
+                if(slice_end>SCREEN_WIDTH){
+                    slice_end=SCREEN_WIDTH;
+                }
+
+                int slice_cycles=(VBLANK_SCANLINES + slice_end) * CYCLES_PER_SCANLINE;
+                if(slice_cycles<target){
+                    target=slice_cycles;
+                }
+            }
+
+            total_cycles=machine_race_beam(machine, total_cycles, target, &next_line);
+
+            if(next_line-pushed>=BEAM_SLICE_LINES || (next_line==SCREEN_WIDTH && pushed<SCREEN_WIDTH)){
+                render_slice(display, machine, pushed, next_line);
+                pushed=next_line;
+            }
+        }
+
+        generate_interrupt(machine, int_num);
+    }
+
+    if(machine->recorder){
+        recorder_frame(machine->recorder, machine->machine_mem+VRAM_START);
+    }
+}
+
+/*Runs the machine frames_ahead frames into the future with the inputs held as they
+are, for run-ahead. The caller snapshots the machine before and restores it after
+converting the screen. These frames never happened, so input is not read and they
+are not traced, recorded, profiled or stopped in by the debugger*/
+static void run_speculative_frames(machine_t* machine, int frames_ahead){
+    trace_t* trace=machine->trace;
+    debugger_t* debugger=machine->debugger;
+    profiler_t* profiler=machine->profiler;
+
+    machine->trace=NULL;
+    machine->debugger=NULL;
+    machine->profiler=NULL;
+
+    for(int i=0; i<frames_ahead; i++){
+        machine_run_frame(machine);
+    }
+
+    machine->trace=trace;
+    machine->debugger=debugger;
+    machine->profiler=profiler;
+}
+
+/*Runs the frames of a fast-forward step that are never shown: speed-1 of them, or with
+a speed of 0 as many as fit into the display frame that started at frame_start.
+VRAM is not converted and nothing is rendered*/
+static void run_skipped_frames(machine_t* machine, int speed, Uint32 frame_start){
+    if(speed>0){
+        for(int i=1; i<speed && machine->quit_status!=1; i++){
+            run_frame(machine);
+        }
+    }
+    else{
+        while(SDL_GetTicks()-frame_start < FAST_FORWARD_BUDGET * (1000.0f / FPS) && machine->quit_status!=1){
+            run_frame(machine);
+        }
+    }
+}
+
+int main(int argc, char* argv[]){
+    int latency_probe=0;
+    int beam_racing=0;
+    int run_ahead=0;
+    char* trace_path=NULL;
+    char* record_path=NULL;
+    char* input_log_path=NULL;
+    char* profile_prefix=NULL;
+    int trace_on_start=0;
+    int debug_on_start=0;
+    char* gdb_address=NULL;
+    char* rom_dir=NULL;
+    int fast_forward=0;
+    int fast_forward_speed=FAST_FORWARD_SPEED;
+    int scale=0;
+    int scanlines=0;
+    int phosphor=0;
+    int show_hud=0;
+    char* metrics_target=NULL;
+    int metrics_interval=METRICS_DEFAULT_INTERVAL;
+    char* netplay_peer=NULL;
+    int netplay_player=1;
+    int netplay_port=0;
+    int netplay_delay=0;
+    int netplay_loss=0;
+
+    for(int i=1; i<argc; i++){
+        if(strcmp(argv[i], "--latency-probe")==0){
+            latency_probe=1;
+        }
+        else if(strcmp(argv[i], "--beam-racing")==0){
+            beam_racing=1;
+        }
+        else if(strcmp(argv[i], "--run-ahead")==0 && i+1<argc){
+            run_ahead=atoi(argv[++i]);
 
+            if(run_ahead<1 || run_ahead>RUN_AHEAD_MAX){
+                printf("Run-ahead must be between 1 and %d frames\n", RUN_AHEAD_MAX);
+                return 1;
+            }
+        }
+        else if(strcmp(argv[i], "--trace")==0 && i+1<argc){
+            trace_path=argv[++i];
+        }
+        else if(strcmp(argv[i], "--record")==0 && i+1<argc){
+            record_path=argv[++i];
+        }
+        else if(strcmp(argv[i], "--record-input")==0 && i+1<argc){
+            input_log_path=argv[++i];
+        }
+        else if(strcmp(argv[i], "--profile")==0 && i+1<argc){
+            profile_prefix=argv[++i];
+        }
+        else if(strcmp(argv[i], "--trace-on-start")==0){
+            trace_on_start=1;
+        }
+        else if(strcmp(argv[i], "--rom-dir")==0 && i+1<argc){
+            rom_dir=argv[++i];
+        }
+        else if(strcmp(argv[i], "--debug")==0){
+            debug_on_start=1;
+        }
+        else if(strcmp(argv[i], "--gdb")==0 && i+1<argc){
+            gdb_address=argv[++i];
+        }
+        else if(strcmp(argv[i], "--fast-forward")==0 && i+1<argc){
+            fast_forward=1;
+            fast_forward_speed=atoi(argv[++i]);
+
+            if(fast_forward_speed<0){
+                printf("Fast-forward speed must be 0 (unlimited) or a multiplier\n");
+                return 1;
+            }
+        }
+        else if(strcmp(argv[i], "--scale")==0 && i+1<argc){
+            scale=atoi(argv[++i]);
+
+            if(scale<SCALER_MIN_SCALE || scale>SCALER_MAX_SCALE){
+                printf("Scale must be between %d and %d\n", SCALER_MIN_SCALE, SCALER_MAX_SCALE);
+                return 1;
+            }
+        }
+        else if(strcmp(argv[i], "--scanlines")==0){
+            scanlines=1;
+        }
+        else if(strcmp(argv[i], "--phosphor")==0){
+            phosphor=1;
+        }
+        else if(strcmp(argv[i], "--hud")==0){
+            show_hud=1;
+        }
+        else if(strcmp(argv[i], "--metrics")==0 && i+1<argc){
+            metrics_target=argv[++i];
+        }
+        else if(strcmp(argv[i], "--metrics-interval")==0 && i+1<argc){
+            metrics_interval=atoi(argv[++i]);
+
+            if(metrics_interval<1){
+                printf("Metrics interval must be at least 1 second\n");
+                return 1;
+            }
+        }
+        else if(strcmp(argv[i], "--netplay")==0 && i+1<argc){
+            netplay_peer=argv[++i];
+        }
+        else if(strcmp(argv[i], "--netplay-player")==0 && i+1<argc){
+            netplay_player=atoi(argv[++i]);
+
+            if(netplay_player<1 || netplay_player>2){
+                printf("Netplay player must be 1 or 2\n");
+                return 1;
+            }
+        }
+        else if(strcmp(argv[i], "--netplay-port")==0 && i+1<argc){
+            netplay_port=atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--netplay-delay")==0 && i+1<argc){
+            netplay_delay=atoi(argv[++i]);
+
+            if(netplay_delay<0 || netplay_delay>NETPLAY_MAX_DELAY_MS){
+                printf("Netplay delay must be between 0 and %d ms\n", NETPLAY_MAX_DELAY_MS);
+                return 1;
+            }
+        }
+        else if(strcmp(argv[i], "--netplay-loss")==0 && i+1<argc){
+            netplay_loss=atoi(argv[++i]);
+
+            if(netplay_loss<0 || netplay_loss>=100){
+                printf("Netplay loss must be between 0 and 99 percent\n");
+                return 1;
+            }
+        }
+        else{
+            printf("Unknown option: %s\n", argv[i]);
+            printf("Usage: %s [--latency-probe] [--beam-racing | --run-ahead n] [--trace file [--trace-on-start]]\n"
+                   "          [--debug] [--gdb port|host:port|unix:path] [--rom-dir dir] [--record file]\n"
+                   "          [--record-input file] [--fast-forward speed] [--scale n] [--scanlines]\n"
+                   "          [--phosphor] [--hud] [--metrics file|unix:path [--metrics-interval s]]\n"
+                   "          [--profile prefix] [--netplay host:port [--netplay-player 1|2] [--netplay-port port]\n"
+                   "          [--netplay-delay ms] [--netplay-loss percent]]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    //Beam racing shows the frame being emulated, run-ahead one from the future
+    if(beam_racing && run_ahead){
+        printf("--beam-racing and --run-ahead cannot be used together\n");
+        return 1;
+    }
+
+    //Netplay frames only run on the inputs both sides agree on, at the pace both keep
+    if(netplay_peer && (beam_racing || run_ahead || fast_forward || record_path || input_log_path)){
+        printf("--netplay cannot be used with --beam-racing, --run-ahead, --fast-forward, --record or --record-input\n");
+        return 1;
+    }
+
+    //Check the ROMs before opening a window
     machine_t* machine=init_machine();
+    machine_attach_screen(machine);
+    char rom_path[ROM_PATH_MAX]="";
+
+#ifdef EMBED_ROMS
+    (void)rom_dir;      //The ROMs are compiled into the executable
+#else
+    if(rom_find_dir(rom_dir, rom_path, sizeof(rom_path))<0){
+        printf("Cannot find the ROM directory, use --rom-dir\n");
+        return 1;
+    }
+#endif
 
     //Load Space Invader ROM files into memory
-    load_game(machine);
+    if(load_game(machine, rom_path)<0){
+        return 1;
+    }
+
+    //The CRT effects need the CPU-side scaler, which defaults to the usual 3x window
+    scaler_t* scaler=NULL;
+    if(scale || scanlines || phosphor){
+        scaler=scaler_init(scale ? scale : 3, scanlines, phosphor);
+
+        if(!scaler){
+            printf("Cannot allocate the scaler buffers\n");
+            return 1;
+        }
+    }
+
+    display_t* game_display=malloc(sizeof(display_t));
+    init_SDL(game_display, scaler);
+
+    if(latency_probe){
+        machine->latency=latency_init();
+    }
+
+    if(trace_path){
+        machine->trace_log=trace_open(trace_path);
+
+        if(!machine->trace_log){
+            printf("Cannot create trace file %s\n", trace_path);
+            exit(1);
+        }
+
+        if(trace_on_start){
+            machine->trace=machine->trace_log;
+        }
+    }
+
+    if(record_path){
+        machine->recorder=recorder_open(record_path, overlay_colors);
+
+        if(!machine->recorder){
+            printf("Cannot create recording %s\n", record_path);
+            exit(1);
+        }
+    }
+
+    if(input_log_path){
+        machine->input_log=replay_create(input_log_path);
+
+        if(!machine->input_log){
+            printf("Cannot create input replay %s\n", input_log_path);
+            exit(1);
+        }
+    }
+
+    if(profile_prefix){
+        machine->profiler=profiler_init();
+    }
+
+    netplay_t* netplay=NULL;
+    if(netplay_peer){
+        if(!netplay_port){
+            netplay_port=NETPLAY_DEFAULT_PORT+netplay_player-1;
+        }
+
+        netplay=netplay_open(netplay_player, netplay_port, netplay_peer);
+
+        if(!netplay){
+            exit(1);
+        }
+
+        netplay_simulate(netplay, netplay_delay, netplay_loss);
+    }
+
+    metrics_t* metrics=NULL;
+    if(metrics_target){
+        metrics=metrics_open(metrics_target, metrics_interval, machine);
+
+        if(!metrics){
+            exit(1);
+        }
+    }
+
+    //The debugger is always available (B breaks into it), it costs nothing until armed
+    machine->debugger=debugger_init(MACHINE_MEM_SIZE);
+
+    if(gdb_address){
+        if(gdb_stub_listen(machine->debugger, gdb_address)<0){
+            exit(1);
+        }
+    }
+    else if(debug_on_start){
+        debugger_request_stop(machine->debugger);
+    }
+
+    machine->fast_forward=fast_forward;
+    machine->show_hud=show_hud;
+
+    //Frames are timed even while the overlay is hidden, so it has history when H is pressed
+    hud_t* hud=hud_init();
+
+    machine_snapshot_t* snapshot=run_ahead ? malloc(sizeof(machine_snapshot_t)) : NULL;
 
     int time=SDL_GetTicks();
 
@@ -23,36 +409,124 @@ int main(){
         if((SDL_GetTicks() - time) > (1.0f / FPS) * 1000){
             //Update elapsed time
             time=SDL_GetTicks();
-            
-            //Get user input
-            keyboard_handler(machine);
 
-            int total_cycles=0;   //Total number of instruction cycles
+            uint64_t frame_start=latency_now_us();
+            uint32_t start_cycles=machine->cpu->instruction_cycles;
+            uint64_t emulated, converted, presented;
+            int changed=1;      //The screen buffer has to be uploaded before presenting
+
+            if(netplay){
+                //While waiting for the peer the last frame stays up, after a rollback the corrected one shows
+                keyboard_handler(machine);
+                netplay_frame(netplay, machine);
+                emulated=latency_now_us();
+
+                //The afterglow fades every frame, even when VRAM did not change
+                changed=machine_refresh_screen(machine) || phosphor;
+            }
+            else if(machine->fast_forward){
+                //Only the last frame of each display frame is converted and presented
+                run_skipped_frames(machine, fast_forward_speed, time);
+                run_frame(machine);
+                emulated=latency_now_us();
+
+                changed=machine_refresh_screen(machine) || phosphor;
+            }
+            else if(beam_racing){
+                //Conversion and uploads happen during emulation, so they count towards it
+                run_frame_beam_racing(machine, game_display);
+                emulated=latency_now_us();
+
+                changed=0;
+            }
+            else if(run_ahead){
+                //Show the frame the machine would reach run_ahead frames from now, then go back
+                run_frame(machine);
+                machine_snapshot(machine, snapshot);
+                run_speculative_frames(machine, run_ahead);
+                emulated=latency_now_us();
+
+                machine_refresh_screen(machine);
+                machine_restore(machine, snapshot);
+            }
+            else{
+                run_frame(machine);
+                emulated=latency_now_us();
+
+                machine_refresh_screen(machine);
+            }
+
+            if(machine->show_hud){
+                hud_draw(hud, machine->screen->pixels);
+
+                //The overlay is drawn over the converted VRAM, so the next frame converts it again
+                machine->screen->valid=0;
+                changed=1;
+            }
 
-            int current_cycle=0;    /*machine->cpu->instruction_cycles-current_cycle
-                                      would give the CPU cycles after executing an instruction*/
+            converted=latency_now_us();
 
-            while(total_cycles<=HALF_CYCLES_PER_FRAME){
-                current_cycle=machine->cpu->instruction_cycles;
-                machine_execute(machine);
-                total_cycles+=machine->cpu->instruction_cycles-current_cycle;
+            if(changed){
+                render_graphics(game_display, machine);
             }
-            //Generate mid-screen interrupt (interrupt number = 1)
-            generate_interrupt(machine, 1);
+            else{
+                present_graphics(game_display);
+            }
+
+            presented=latency_now_us();
+            hud_frame(hud, emulated-frame_start, converted-emulated, presented-converted,
+                      (uint32_t)machine->cpu->instruction_cycles-start_cycles);
 
-            current_cycle=0;
+            if(machine->latency){
+                latency_frame_presented(machine->latency);
+            }
 
-            while(total_cycles<=CYCLES_PER_FRAME){
-                current_cycle=machine->cpu->instruction_cycles;
-                machine_execute(machine);
-                total_cycles+=machine->cpu->instruction_cycles-current_cycle;
+            if(metrics){
+                metrics_frame(metrics, machine);
             }
-            //Generate end-of-screen interrupt (interrupt number = 2)
-            generate_interrupt(machine, 2);
-            
-            machine_update_screen(machine);
-            render_graphics(game_display, machine);
+
+            debugger_poll(machine->debugger);
+        }
+    }
+
+    if(machine->latency){
+        latency_report(machine->latency);
+        latency_destroy(machine->latency);
+    }
+
+    if(metrics){
+        metrics_close(metrics, machine);
+    }
+
+    if(netplay){
+        netplay_print_stats(netplay, stdout);
+        netplay_close(netplay);
+    }
+
+    debugger_destroy(machine->debugger);
+    hud_destroy(hud);
+    free(snapshot);
+
+    if(machine->trace_log){
+        printf("Traced %llu instructions\n", (unsigned long long)machine->trace_log->num_records);
+        trace_close(machine->trace_log);
+    }
+
+    if(machine->recorder){
+        printf("Recorded %llu frames\n", (unsigned long long)machine->recorder->num_frames);
+        recorder_close(machine->recorder);
+    }
+
+    if(machine->input_log){
+        printf("Recorded %u input samples\n", machine->input_log->num_samples);
+        replay_close(machine->input_log);
+    }
+
+    if(machine->profiler){
+        if(profiler_save(machine->profiler, profile_prefix, machine->machine_mem, MACHINE_MEM_SIZE)==0){
+            printf("Wrote profile %s.folded and %s.txt\n", profile_prefix, profile_prefix);
         }
+        profiler_destroy(machine->profiler);
     }
 
     destroy_SDL(game_display);
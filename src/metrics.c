@@ -0,0 +1,189 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "metrics.h"
+
+#define METRICS_BUFFER_SIZE		(16 * METRICS_RECORD_MAX)
+
+static uint64_t process_cpu_us(){
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    return (uint64_t)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000 +
+           usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+static double wall_seconds(){
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+//Connects to a listening Unix stream socket, returns NULL if nobody is there
+static FILE* open_socket(const char* path){
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family=AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path)-1);
+
+    int fd=socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd<0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr))<0){
+        if(fd>=0){
+            close(fd);
+        }
+        return NULL;
+    }
+
+    //A collector that goes away must not take the emulator with it
+    signal(SIGPIPE, SIG_IGN);
+
+    return fdopen(fd, "w");
+}
+
+metrics_t* metrics_open(const char* target, int interval, machine_t* machine){
+    FILE* fp;
+
+    if(strncmp(target, "unix:", 5)==0){
+        fp=open_socket(target+5);
+    }
+    else{
+        fp=fopen(target, "a");
+    }
+
+    if(!fp){
+        printf("Cannot open metrics sink %s\n", target);
+        return NULL;
+    }
+
+    metrics_t* metrics=calloc(1, sizeof(metrics_t));
+
+    if(interval<1){
+        interval=1;
+    }
+
+    metrics->writer=async_writer_open_stream(fp, METRICS_BUFFER_SIZE);
+    metrics->interval_us=(uint64_t)interval * 1000000;
+
+    //Room for twice the expected frame count, the rest of a slow interval goes unsampled
+    metrics->max_frames=interval * FPS * 2;
+    metrics->frame_us=malloc(sizeof(uint32_t) * metrics->max_frames);
+
+    metrics->start_us=latency_now_us();
+    metrics->last_counters=machine->counters;
+    metrics->last_cpu_us=process_cpu_us();
+
+    return metrics;
+}
+
+static int compare_u32(const void* a, const void* b){
+    uint32_t x=*(const uint32_t*)a;
+    uint32_t y=*(const uint32_t*)b;
+
+    return (x>y)-(x<y);
+}
+
+//Writes the record for the interval ending now and starts the next one
+static void write_record(metrics_t* metrics, machine_t* machine, uint64_t now){
+    double elapsed=(now-metrics->start_us) / 1e6;
+    uint64_t cpu_us=process_cpu_us();
+    const machine_counters_t* c=&machine->counters;
+    const machine_counters_t* last=&metrics->last_counters;
+    uint64_t instructions=c->instructions-last->instructions;
+    uint64_t cycles=c->cycles-last->cycles;
+    int n=metrics->num_frames;
+    double p50=0, p95=0, p99=0, max=0;
+
+    if(elapsed<=0){
+        elapsed=1e-6;
+    }
+
+    if(n>0){
+        qsort(metrics->frame_us, n, sizeof(uint32_t), compare_u32);
+
+        p50=metrics->frame_us[n * 50 / 100] / 1000.0;
+        p95=metrics->frame_us[n * 95 / 100] / 1000.0;
+        p99=metrics->frame_us[n * 99 / 100] / 1000.0;
+        max=metrics->frame_us[n-1] / 1000.0;
+    }
+
+    /*Records wait in the current buffer while the writer thread is busy. If that fills
+    up, the collector has stopped reading and the record is dropped rather than making
+    the emulation wait for it*/
+    async_writer_t* writer=metrics->writer;
+
+    if(writer->used+METRICS_RECORD_MAX>writer->buffer_size){
+        metrics->dropped_records++;
+    }
+    else{
+        char* line=async_writer_reserve(writer, METRICS_RECORD_MAX);
+        int len=snprintf(line, METRICS_RECORD_MAX,
+            "{\"time\":%.3f,\"seq\":%llu,\"interval_s\":%.3f,\"frames\":%d,"
+            "\"frame_ms_p50\":%.2f,\"frame_ms_p95\":%.2f,\"frame_ms_p99\":%.2f,\"frame_ms_max\":%.2f,"
+            "\"dropped_frames\":%llu,\"cycles\":%llu,\"instructions\":%llu,\"instructions_per_s\":%.0f,"
+            "\"emulated_mhz\":%.3f,\"host_cpu_s\":%.3f,\"interrupts\":%llu,\"interrupts_dropped\":%llu,"
+            "\"records_dropped\":%llu}\n",
+            wall_seconds(), (unsigned long long)metrics->num_records, elapsed, n,
+            p50, p95, p99, max,
+            (unsigned long long)metrics->dropped_frames, (unsigned long long)cycles,
+            (unsigned long long)instructions, instructions / elapsed,
+            cycles / elapsed / 1e6, (cpu_us-metrics->last_cpu_us) / 1e6,
+            (unsigned long long)(c->interrupts-last->interrupts),
+            (unsigned long long)(c->interrupts_dropped-last->interrupts_dropped),
+            (unsigned long long)metrics->dropped_records);
+
+        if(len>=METRICS_RECORD_MAX){
+            len=METRICS_RECORD_MAX-1;
+        }
+        async_writer_unreserve(writer, METRICS_RECORD_MAX-len);
+    }
+
+    //Hand the record to the writer thread now rather than when the buffer fills
+    async_writer_try_flush(writer);
+
+    metrics->num_records++;
+    metrics->num_frames=0;
+    metrics->dropped_frames=0;
+    metrics->start_us=now;
+    metrics->last_counters=*c;
+    metrics->last_cpu_us=cpu_us;
+}
+
+void metrics_frame(metrics_t* metrics, machine_t* machine){
+    uint64_t now=latency_now_us();
+
+    if(metrics->last_frame_us){
+        uint32_t frame_us=now-metrics->last_frame_us;
+        uint32_t period_us=1000000 / FPS;
+
+        if(metrics->num_frames<metrics->max_frames){
+            metrics->frame_us[metrics->num_frames++]=frame_us;
+        }
+
+        //A frame that took more than 1.5 refreshes left the display showing a stale one
+        if(frame_us > period_us + period_us/2){
+            metrics->dropped_frames+=(frame_us + period_us/2) / period_us - 1;
+        }
+    }
+
+    metrics->last_frame_us=now;
+
+    if(now-metrics->start_us>=metrics->interval_us){
+        write_record(metrics, machine, now);
+    }
+}
+
+void metrics_close(metrics_t* metrics, machine_t* machine){
+    write_record(metrics, machine, latency_now_us());
+
+    async_writer_close(metrics->writer);
+    free(metrics->frame_us);
+    free(metrics);
+}
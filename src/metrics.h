@@ -0,0 +1,47 @@
+#ifndef metrics_H
+#define metrics_H
+
+#include <stdint.h>
+
+#include "machine.h"
+#include "async_writer.h"
+
+#define METRICS_DEFAULT_INTERVAL	10		//Seconds between records
+#define METRICS_RECORD_MAX		512		//Longest JSON line
+
+/*Periodic JSON-lines health records for unattended cabinets. The emulation thread
+feeds it one call per presented frame and it reads the machine's counters on that
+same thread, so nothing on the emulation path takes a lock. Records are formatted
+into an async_writer, whose thread does the file or socket I/O*/
+typedef struct{
+    async_writer_t* writer;
+    uint64_t interval_us;
+
+    //Host time between presented frames during the current interval
+    uint32_t* frame_us;
+    int num_frames;
+    int max_frames;
+
+    uint64_t start_us;		//Start of the current interval
+    uint64_t last_frame_us;
+    uint64_t dropped_frames;	//Display refreshes that went by without a new frame
+
+    machine_counters_t last_counters;	//Counters at the start of the interval
+    uint64_t last_cpu_us;		//Process CPU time at the start of the interval
+
+    uint64_t num_records;
+    uint64_t dropped_records;	//Records not written because the collector stopped reading
+} metrics_t;
+
+/*Opens a sink writing a record every interval seconds to target, which is a file
+(appended to) or "unix:path" for a listening Unix stream socket. Returns NULL, after
+printing why, if it cannot be opened*/
+metrics_t* metrics_open(const char* target, int interval, machine_t* machine);
+
+//Writes a last record for the partial interval and closes the sink
+void metrics_close(metrics_t* metrics, machine_t* machine);
+
+//A frame has been presented, writes a record when the interval is up
+void metrics_frame(metrics_t* metrics, machine_t* machine);
+
+#endif
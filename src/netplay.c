@@ -0,0 +1,386 @@
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "netplay.h"
+#include "latency.h"
+
+/*Packet layout, big-endian:
+  0  magic "I80N"
+  4  frame of the first input
+  8  ack, the next frame of the receiver's inputs the sender is missing
+ 12  frame the sender is about to run
+ 16  sender's lead over the receiver in frames, signed
+ 17  number of inputs, one byte each*/
+
+static void put32(uint8_t* p, uint32_t value){
+    p[0]=value>>24;
+    p[1]=value>>16;
+    p[2]=value>>8;
+    p[3]=value;
+}
+
+static uint32_t get32(const uint8_t* p){
+    return ((uint32_t)p[0]<<24) | ((uint32_t)p[1]<<16) | ((uint32_t)p[2]<<8) | p[3];
+}
+
+netplay_t* netplay_open(int player, int local_port, const char* peer){
+    char host[64]="127.0.0.1";
+    const char* port=strrchr(peer, ':');
+
+    if(port){
+        snprintf(host, sizeof(host), "%.*s", (int)(port-peer), peer);
+        port++;
+    }
+    else{
+        port=peer;
+    }
+
+    struct sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family=AF_INET;
+    local.sin_addr.s_addr=htonl(INADDR_ANY);
+    local.sin_port=htons(local_port);
+
+    struct sockaddr_in remote;
+    memset(&remote, 0, sizeof(remote));
+    remote.sin_family=AF_INET;
+    remote.sin_port=htons(atoi(port));
+
+    if(inet_pton(AF_INET, host, &remote.sin_addr)!=1){
+        printf("Invalid netplay peer %s\n", peer);
+        return NULL;
+    }
+
+    int fd=socket(AF_INET, SOCK_DGRAM, 0);
+    if(fd<0 || bind(fd, (struct sockaddr*)&local, sizeof(local))<0){
+        printf("Cannot bind netplay port %d\n", local_port);
+        if(fd>=0) close(fd);
+        return NULL;
+    }
+
+    //Only the peer's packets are received from now on
+    if(connect(fd, (struct sockaddr*)&remote, sizeof(remote))<0){
+        printf("Cannot reach netplay peer %s\n", peer);
+        close(fd);
+        return NULL;
+    }
+
+    netplay_t* netplay=calloc(1, sizeof(netplay_t));
+    netplay->fd=fd;
+    netplay->player=player-1;
+    netplay->snapshots=malloc(NETPLAY_MAX_ROLLBACK * sizeof(machine_snapshot_t));
+    netplay->queue=malloc(NETPLAY_QUEUE_SIZE * sizeof(netplay_packet_t));
+    netplay->seed=player;
+
+    printf("Netplay as player %d on port %d, waiting for %s ...\n", player, local_port, peer);
+    fflush(stdout);
+
+    return netplay;
+}
+
+void netplay_close(netplay_t* netplay){
+    close(netplay->fd);
+    free(netplay->snapshots);
+    free(netplay->queue);
+    free(netplay);
+}
+
+void netplay_simulate(netplay_t* netplay, int delay_ms, int loss_percent){
+    netplay->delay_ms=delay_ms;
+    netplay->loss_percent=loss_percent;
+}
+
+void netplay_run_frame(machine_t* machine, uint8_t player1, uint8_t player2){
+    machine->port_in1=(1<<3) | (player1 & NETPLAY_BUTTONS) | (player2 & NETPLAY_BUTTONS & ~NETPLAY_CONTROLS);
+    machine->port_in2=(machine->port_in2 & ~NETPLAY_CONTROLS) | (player2 & NETPLAY_CONTROLS);
+
+    machine_run_frame(machine);
+}
+
+//Sends the packets whose artificial delay is over
+static void flush_queue(netplay_t* netplay){
+    uint64_t now=latency_now_us();
+
+    while(netplay->queue_head!=netplay->queue_tail && netplay->queue[netplay->queue_head].due_us<=now){
+        netplay_packet_t* packet=&netplay->queue[netplay->queue_head];
+
+        //Errors such as the peer's port not being open yet are no different from loss
+        send(netplay->fd, packet->data, packet->length, MSG_DONTWAIT);
+        netplay->queue_head=(netplay->queue_head+1) % NETPLAY_QUEUE_SIZE;
+    }
+}
+
+static void send_packet(netplay_t* netplay, const uint8_t* data, int length){
+    netplay->stats.packets_sent++;
+
+    if(netplay->loss_percent){
+        netplay->seed=netplay->seed*1103515245 + 12345;
+
+        if((int)((netplay->seed>>16) % 100)<netplay->loss_percent){
+            netplay->stats.packets_dropped++;
+            return;
+        }
+    }
+
+    if(netplay->delay_ms==0){
+        send(netplay->fd, data, length, MSG_DONTWAIT);
+        return;
+    }
+
+    //A full queue lets its oldest packet go early
+    int next=(netplay->queue_tail+1) % NETPLAY_QUEUE_SIZE;
+    if(next==netplay->queue_head){
+        netplay->queue[netplay->queue_head].due_us=0;
+        flush_queue(netplay);
+    }
+
+    netplay_packet_t* packet=&netplay->queue[netplay->queue_tail];
+    packet->due_us=latency_now_us() + (uint64_t)netplay->delay_ms * 1000;
+    packet->length=length;
+    memcpy(packet->data, data, length);
+    netplay->queue_tail=next;
+}
+
+//Sends every local input the peer has not acknowledged
+static void send_inputs(netplay_t* netplay){
+    uint8_t data[NETPLAY_PACKET_MAX];
+    uint32_t count=netplay->frame-netplay->peer_ack;
+    int advantage=(int)(netplay->frame-netplay->peer_frame);
+
+    if(count>NETPLAY_HISTORY){
+        count=NETPLAY_HISTORY;
+    }
+
+    if(advantage>127) advantage=127;
+    if(advantage<-128) advantage=-128;
+
+    memcpy(data, NETPLAY_MAGIC, 4);
+    put32(data+4, netplay->frame-count);
+    put32(data+8, netplay->remote_next);
+    put32(data+12, netplay->frame);
+    data[16]=(uint8_t)(int8_t)advantage;
+    data[17]=count;
+
+    for(uint32_t i=0; i<count; i++){
+        data[NETPLAY_HEADER+i]=netplay->local[(netplay->frame-count+i) % NETPLAY_HISTORY];
+    }
+
+    send_packet(netplay, data, NETPLAY_HEADER+count);
+}
+
+/*Takes in the peer's packets. Returns the first frame already run with a predicted
+input that turned out wrong, or the current frame if there is none*/
+static uint32_t receive_inputs(netplay_t* netplay){
+    uint8_t data[NETPLAY_PACKET_MAX];
+    uint32_t rollback_frame=netplay->frame;
+
+    while(1){
+        ssize_t length=recv(netplay->fd, data, sizeof(data), MSG_DONTWAIT);
+
+        if(length<0){
+            //A packet of ours that found the peer's port closed, reported once
+            if(errno==ECONNREFUSED){
+                continue;
+            }
+            break;
+        }
+
+        if(length<NETPLAY_HEADER || memcmp(data, NETPLAY_MAGIC, 4)!=0 || length!=NETPLAY_HEADER+data[17]){
+            continue;
+        }
+
+        uint32_t first=get32(data+4);
+        uint32_t ack=get32(data+8);
+        uint32_t sender_frame=get32(data+12);
+
+        //The peer cannot have inputs that have not been made yet
+        if(ack>netplay->frame){
+            continue;
+        }
+
+        netplay->stats.packets_received++;
+        netplay->connected=1;
+
+        if(ack>netplay->peer_ack){
+            netplay->peer_ack=ack;
+        }
+
+        if(sender_frame>=netplay->peer_frame){
+            netplay->peer_frame=sender_frame;
+            netplay->peer_advantage=(int8_t)data[16];
+        }
+
+        //Inputs are taken in frame order, the ones already known are skipped
+        for(int i=0; i<data[17]; i++){
+            uint32_t frame=first+i;
+            uint8_t input=data[NETPLAY_HEADER+i];
+
+            if(frame<netplay->remote_next){
+                continue;
+            }
+
+            //A gap, or so far ahead that the slots still needed for rollbacks would be reused
+            if(frame>netplay->remote_next || frame>=netplay->frame+NETPLAY_HISTORY-NETPLAY_MAX_ROLLBACK){
+                break;
+            }
+
+            uint8_t* slot=&netplay->remote[frame % NETPLAY_HISTORY];
+            if(frame<netplay->frame && *slot!=input && frame<rollback_frame){
+                rollback_frame=frame;
+            }
+
+            *slot=input;
+            netplay->remote_next++;
+        }
+    }
+
+    return rollback_frame;
+}
+
+//Runs frame, which is either new or being run again after a rollback
+static void run_frame(netplay_t* netplay, machine_t* machine, uint32_t frame){
+    uint8_t* remote=&netplay->remote[frame % NETPLAY_HISTORY];
+    uint8_t local=netplay->local[frame % NETPLAY_HISTORY];
+
+    //The peer is predicted to hold on to whatever it pressed last
+    if(frame>=netplay->remote_next){
+        *remote=netplay->remote_next ? netplay->remote[(netplay->remote_next-1) % NETPLAY_HISTORY] : 0;
+    }
+
+    machine_snapshot(machine, &netplay->snapshots[frame % NETPLAY_MAX_ROLLBACK]);
+
+    if(netplay->player==0){
+        netplay_run_frame(machine, local, *remote);
+    }
+    else{
+        netplay_run_frame(machine, *remote, local);
+    }
+}
+
+/*Restores the state before frame from and runs the frames since again. They already
+ran once, so they are not traced, profiled or stopped in by the debugger again*/
+static void roll_back(netplay_t* netplay, machine_t* machine, uint32_t from){
+    uint64_t start=latency_now_us();
+    int depth=netplay->frame-from;
+    trace_t* trace=machine->trace;
+    debugger_t* debugger=machine->debugger;
+    struct profiler* profiler=machine->profiler;
+
+    machine_restore(machine, &netplay->snapshots[from % NETPLAY_MAX_ROLLBACK]);
+
+    machine->trace=NULL;
+    machine->debugger=NULL;
+    machine->profiler=NULL;
+
+    for(uint32_t frame=from; frame<netplay->frame; frame++){
+        run_frame(netplay, machine, frame);
+    }
+
+    machine->trace=trace;
+    machine->debugger=debugger;
+    machine->profiler=profiler;
+
+    uint64_t elapsed=latency_now_us()-start;
+
+    netplay->stats.rollbacks++;
+    netplay->stats.resimulated+=depth;
+    netplay->stats.depths[depth]++;
+
+    if(depth>netplay->stats.max_depth){
+        netplay->stats.max_depth=depth;
+    }
+
+    if(elapsed>netplay->stats.max_rollback_us){
+        netplay->stats.max_rollback_us=elapsed;
+    }
+}
+
+//Receives, and rolls back if a prediction was wrong
+static void update(netplay_t* netplay, machine_t* machine){
+    flush_queue(netplay);
+
+    uint32_t rollback_frame=receive_inputs(netplay);
+    if(rollback_frame<netplay->frame){
+        roll_back(netplay, machine, rollback_frame);
+    }
+}
+
+int netplay_frame(netplay_t* netplay, machine_t* machine){
+    uint8_t in1=machine->port_in1;
+    uint8_t in2=machine->port_in2;
+    int advanced=0;
+
+    update(netplay, machine);
+
+    int advantage=(int)(netplay->frame-netplay->peer_frame);
+
+    if(!netplay->connected){
+        //Nothing runs until the peer is there, so both start at about the same time
+    }
+    else if((int)(netplay->frame-netplay->remote_next)>=NETPLAY_MAX_ROLLBACK ||
+            netplay->frame-netplay->peer_ack>=NETPLAY_HISTORY){
+        netplay->stats.stalls++;
+    }
+    else if(netplay->frame>=netplay->next_sync_frame && advantage-netplay->peer_advantage>=2){
+        //Both leads are measured with the same latency, half the difference is how far ahead we are
+        netplay->next_sync_frame=netplay->frame+NETPLAY_SYNC_INTERVAL;
+        netplay->stats.sync_waits++;
+    }
+    else{
+        netplay->local[netplay->frame % NETPLAY_HISTORY]=in1 & NETPLAY_BUTTONS;
+        run_frame(netplay, machine, netplay->frame);
+
+        netplay->frame++;
+        netplay->stats.frames++;
+        advanced=1;
+    }
+
+    send_inputs(netplay);
+
+    machine->port_in1=in1;
+    machine->port_in2=in2;
+
+    return advanced;
+}
+
+void netplay_poll(netplay_t* netplay, machine_t* machine){
+    uint8_t in1=machine->port_in1;
+    uint8_t in2=machine->port_in2;
+
+    update(netplay, machine);
+    send_inputs(netplay);
+
+    machine->port_in1=in1;
+    machine->port_in2=in2;
+}
+
+void netplay_print_stats(const netplay_t* netplay, FILE* out){
+    const netplay_stats_t* stats=&netplay->stats;
+    double frames=stats->frames ? stats->frames : 1;
+
+    fprintf(out, "Netplay: %llu frames, %llu stalls, %llu sync waits\n", (unsigned long long)stats->frames,
+            (unsigned long long)stats->stalls, (unsigned long long)stats->sync_waits);
+    fprintf(out, "Rollbacks: %llu (%.1f%% of frames), %llu frames re-simulated, depth avg %.1f max %d, longest %.2f ms\n",
+            (unsigned long long)stats->rollbacks, 100.0 * stats->rollbacks / frames,
+            (unsigned long long)stats->resimulated,
+            stats->rollbacks ? (double)stats->resimulated / stats->rollbacks : 0.0,
+            stats->max_depth, stats->max_rollback_us / 1000.0);
+
+    if(stats->rollbacks){
+        fprintf(out, "Rollback depth:");
+        for(int depth=1; depth<=NETPLAY_MAX_ROLLBACK; depth++){
+            if(stats->depths[depth]){
+                fprintf(out, " %d:%llu", depth, (unsigned long long)stats->depths[depth]);
+            }
+        }
+        fprintf(out, "\n");
+    }
+
+    fprintf(out, "Packets: %llu sent, %llu received, %llu dropped\n", (unsigned long long)stats->packets_sent,
+            (unsigned long long)stats->packets_received, (unsigned long long)stats->packets_dropped);
+}
@@ -0,0 +1,106 @@
+#ifndef netplay_H
+#define netplay_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "machine.h"
+
+#define NETPLAY_DEFAULT_PORT	4080		//UDP port of player 1, player 2 uses the next one
+#define NETPLAY_MAX_ROLLBACK	8		//Frames run ahead of the peer's inputs, and so the deepest rollback
+#define NETPLAY_HISTORY		64		//Frames of inputs kept for resending and rollbacks
+#define NETPLAY_SYNC_INTERVAL	10		//Frames between waits that let a peer that is behind catch up
+#define NETPLAY_MAX_DELAY_MS	1000
+#define NETPLAY_QUEUE_SIZE	256		//Packets held back by the artificial delay
+
+#define NETPLAY_BUTTONS		0x77		//Coin, start and player controls, laid out as in port 1
+#define NETPLAY_CONTROLS	0x70		//Fire, left and right, which each player has their own of
+
+#define NETPLAY_MAGIC		"I80N"
+#define NETPLAY_HEADER		18
+#define NETPLAY_PACKET_MAX	(NETPLAY_HEADER + NETPLAY_HISTORY)
+
+typedef struct{
+    uint64_t frames;		//Frames run for the first time
+    uint64_t stalls;		//Host frames without a new frame, waiting for the peer's inputs
+    uint64_t sync_waits;	//Host frames given up to let the peer catch up
+
+    uint64_t rollbacks;
+    uint64_t resimulated;	//Frames run again after rollbacks
+    uint64_t depths[NETPLAY_MAX_ROLLBACK + 1];	//Rollbacks by number of frames re-simulated
+    int max_depth;
+    uint64_t max_rollback_us;	//Longest restore and re-simulation
+
+    uint64_t packets_sent;
+    uint64_t packets_received;
+    uint64_t packets_dropped;	//By the artificial loss
+} netplay_stats_t;
+
+typedef struct{
+    uint64_t due_us;
+    int length;
+    uint8_t data[NETPLAY_PACKET_MAX];
+} netplay_packet_t;
+
+/*Rollback netplay for two cabinets over UDP. Every host frame each side sends the
+inputs the peer has not acknowledged yet, so a lost packet is made up for by the
+next one, and runs a new frame straight away with the peer's input predicted to be
+the last one received. When the real input turns out different, the machine is
+restored to the snapshot taken before that frame and the frames since are run again
+with it, all within the same host frame. Frames run again are not traced, profiled or
+stopped in by the debugger, as they were the first time. A side that gets
+NETPLAY_MAX_ROLLBACK frames ahead of the peer's inputs stalls until they arrive.
+
+Both machines start from power-on and are only driven by the inputs exchanged here,
+so they stay identical. Player 1's buttons go to port 1, player 2's fire, left and
+right to port 2 and their coin and start buttons to port 1 as well*/
+typedef struct{
+    int fd;
+    int player;			//0 for player 1, 1 for player 2
+    int connected;		//A packet has arrived from the peer
+
+    uint32_t frame;		//Next frame to run
+    uint32_t remote_next;	//The peer's inputs are known for every frame before this
+    uint32_t peer_ack;		//The peer has our inputs for every frame before this
+    uint32_t peer_frame;	//Latest frame the peer reported running, and its lead over us then
+    int peer_advantage;
+    uint32_t next_sync_frame;
+
+    uint8_t local[NETPLAY_HISTORY];
+    uint8_t remote[NETPLAY_HISTORY];	//As received, or as predicted from remote_next on
+    machine_snapshot_t* snapshots;	//State before each of the last NETPLAY_MAX_ROLLBACK frames
+
+    //Artificial network conditions applied to sent packets
+    int delay_ms;
+    int loss_percent;
+    uint32_t seed;
+    netplay_packet_t* queue;
+    int queue_head, queue_tail;
+
+    netplay_stats_t stats;
+} netplay_t;
+
+/*Binds UDP port local_port and exchanges inputs with peer ("host:port"), playing as
+player 1 or 2. Returns NULL, after printing why, if the socket cannot be set up*/
+netplay_t* netplay_open(int player, int local_port, const char* peer);
+
+void netplay_close(netplay_t* netplay);
+
+//Delays every packet sent by delay_ms and drops loss_percent of them, for testing
+void netplay_simulate(netplay_t* netplay, int delay_ms, int loss_percent);
+
+/*Runs one host frame: takes in the peer's inputs, rolls back if they differ from
+the predictions, then runs the next frame with the local buttons read from the
+machine's port 1. The input ports are left holding the local buttons. Returns 1 if
+a new frame was run, 0 if it had to wait for the peer*/
+int netplay_frame(netplay_t* netplay, machine_t* machine);
+
+//Same as netplay_frame(), without running a new frame, to let the peer catch up at the end
+void netplay_poll(netplay_t* netplay, machine_t* machine);
+
+//Runs a frame with both players' buttons on the input ports
+void netplay_run_frame(machine_t* machine, uint8_t player1, uint8_t player2);
+
+void netplay_print_stats(const netplay_t* netplay, FILE* out);
+
+#endif
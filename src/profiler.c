@@ -0,0 +1,277 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "profiler.h"
+#include "disassembler.h"
+
+//Function names as in the disassembler's listing, interrupt entries get their own
+static void function_name(char* buf, size_t len, const profiler_node_t* node){
+    snprintf(buf, len, "%s_%04x", node->interrupt ? "INT" : "SUB", node->function);
+}
+
+profiler_t* profiler_init(){
+    profiler_t* profiler=calloc(1, sizeof(profiler_t));
+
+    profiler->nodes=calloc(PROFILER_MAX_NODES, sizeof(profiler_node_t));
+    profiler->hash=calloc(PROFILER_HASH_SIZE, sizeof(uint32_t));
+    profiler->pc_cycles=calloc(0x10000, sizeof(uint64_t));
+    profiler->pc_count=calloc(0x10000, sizeof(uint64_t));
+
+    //The root stays at the bottom of the stack for good
+    profiler->num_nodes=1;
+    profiler->stack[0].node=0;
+    profiler->stack[0].sp=0xFFFF;
+    profiler->depth=1;
+
+    return profiler;
+}
+
+void profiler_destroy(profiler_t* profiler){
+    free(profiler->nodes);
+    free(profiler->hash);
+    free(profiler->pc_cycles);
+    free(profiler->pc_count);
+    free(profiler);
+}
+
+//Returns the node for function called from parent, creating it if needed, or -1 if the table is full
+static int child_node(profiler_t* profiler, uint32_t parent, uint16_t function, int interrupt){
+    uint32_t key=(parent<<17) ^ ((uint32_t)interrupt<<16) ^ function;
+    uint32_t slot=(key * 2654435761u) % PROFILER_HASH_SIZE;
+
+    while(profiler->hash[slot]){
+        profiler_node_t* node=&profiler->nodes[profiler->hash[slot]-1];
+
+        if(node->parent==parent && node->function==function && node->interrupt==interrupt){
+            return profiler->hash[slot]-1;
+        }
+
+        slot=(slot+1) % PROFILER_HASH_SIZE;
+    }
+
+    if(profiler->num_nodes==PROFILER_MAX_NODES){
+        return -1;
+    }
+
+    int index=profiler->num_nodes++;
+    profiler->nodes[index].parent=parent;
+    profiler->nodes[index].function=function;
+    profiler->nodes[index].interrupt=interrupt;
+    profiler->hash[slot]=index+1;
+
+    return index;
+}
+
+void profiler_enter(profiler_t* profiler, uint16_t function, uint16_t sp, int interrupt){
+    int node=-1;
+
+    if(profiler->depth<PROFILER_MAX_DEPTH){
+        node=child_node(profiler, profiler->stack[profiler->depth-1].node, function, interrupt);
+    }
+
+    if(node<0){
+        profiler->dropped_calls++;
+        return;
+    }
+
+    profiler->nodes[node].calls++;
+    profiler->stack[profiler->depth].node=node;
+    profiler->stack[profiler->depth].sp=sp;
+    profiler->depth++;
+}
+
+void profiler_leave(profiler_t* profiler, uint16_t sp){
+    /*Pops the frame whose return address this was, along with any frames above it that
+    were abandoned without a RET. A return from deeper than the top frame (a pushed
+    address used as a jump) leaves the stack alone*/
+    while(profiler->depth>1 && profiler->stack[profiler->depth-1].sp<=sp){
+        profiler->depth--;
+    }
+}
+
+void profiler_interrupt(profiler_t* profiler, uint16_t vector, uint16_t sp, int cycles){
+    profiler_enter(profiler, vector, sp, 1);
+
+    profiler->nodes[profiler->stack[profiler->depth-1].node].cycles+=cycles;
+    profiler->total_cycles+=cycles;
+}
+
+static void write_path(profiler_t* profiler, FILE* out, uint32_t index){
+    char name[16];
+
+    if(index==0){
+        fprintf(out, "main");
+        return;
+    }
+
+    write_path(profiler, out, profiler->nodes[index].parent);
+    function_name(name, sizeof(name), &profiler->nodes[index]);
+    fprintf(out, ";%s", name);
+}
+
+void profiler_write_folded(profiler_t* profiler, FILE* out){
+    for(int i=0; i<profiler->num_nodes; i++){
+        if(profiler->nodes[i].cycles){
+            write_path(profiler, out, i);
+            fprintf(out, " %llu\n", (unsigned long long)profiler->nodes[i].cycles);
+        }
+    }
+}
+
+//Totals of one function over all the paths that reach it
+typedef struct{
+    profiler_node_t* node;	//Any node of the function, for its name
+    uint64_t inclusive;
+    uint64_t exclusive;
+    uint64_t calls;
+} function_total_t;
+
+static int compare_inclusive(const void* a, const void* b){
+    const function_total_t* x=a;
+    const function_total_t* y=b;
+
+    return (x->inclusive<y->inclusive)-(x->inclusive>y->inclusive);
+}
+
+void profiler_write_report(profiler_t* profiler, FILE* out, const uint8_t* mem, int mem_size){
+    int n=profiler->num_nodes;
+    uint64_t* subtree=calloc(n, sizeof(uint64_t));
+    int* function_of=calloc(n, sizeof(int));     //Index into functions for each node
+    int* index_of=malloc(sizeof(int) * 0x20000);  //Index into functions for each entry address
+    function_total_t* functions=calloc(n, sizeof(function_total_t));
+    int num_functions=1;
+    double total=profiler->total_cycles ? profiler->total_cycles : 1;
+
+    //Children are always created after their parent, so one backwards pass sums the subtrees
+    for(int i=n-1; i>=0; i--){
+        subtree[i]+=profiler->nodes[i].cycles;
+        if(i>0){
+            subtree[profiler->nodes[i].parent]+=subtree[i];
+        }
+    }
+
+    memset(index_of, 0xFF, sizeof(int) * 0x20000);
+    functions[0].node=&profiler->nodes[0];       //main, which is not an entry address
+
+    for(int i=0; i<n; i++){
+        profiler_node_t* node=&profiler->nodes[i];
+        int f=0;
+
+        if(i>0){
+            int key=(node->interrupt<<16) | node->function;
+
+            if(index_of[key]<0){
+                index_of[key]=num_functions;
+                functions[num_functions++].node=node;
+            }
+            f=index_of[key];
+        }
+
+        function_of[i]=f;
+        functions[f].exclusive+=node->cycles;
+        functions[f].calls+=node->calls;
+
+        //Recursive paths count once, at the outermost call of the function
+        int outermost=1;
+        for(uint32_t up=node->parent; i>0 && up>0; up=profiler->nodes[up].parent){
+            if(function_of[up]==f){
+                outermost=0;
+                break;
+            }
+        }
+
+        if(outermost){
+            functions[f].inclusive+=subtree[i];
+        }
+    }
+
+    qsort(functions, num_functions, sizeof(function_total_t), compare_inclusive);
+
+    fprintf(out, "Guest profile: %llu cycles (%.1f s emulated), %d call paths",
+            (unsigned long long)profiler->total_cycles, profiler->total_cycles / 2e6, n);
+    if(profiler->dropped_calls){
+        fprintf(out, ", %llu calls not tracked", (unsigned long long)profiler->dropped_calls);
+    }
+    fprintf(out, "\n\n      inclusive           exclusive          calls  function\n");
+
+    for(int f=0; f<num_functions; f++){
+        char name[16]="main";
+
+        if(functions[f].node!=profiler->nodes){
+            function_name(name, sizeof(name), functions[f].node);
+        }
+
+        fprintf(out, "%12llu %5.1f%%  %12llu %5.1f%%  %10llu  %s\n",
+                (unsigned long long)functions[f].inclusive, 100.0 * functions[f].inclusive / total,
+                (unsigned long long)functions[f].exclusive, 100.0 * functions[f].exclusive / total,
+                (unsigned long long)functions[f].calls, name);
+    }
+
+    //Every executed instruction in address order, with the function entries labelled
+    uint8_t* entries=calloc(0x10000, 1);
+    for(int i=1; i<n; i++){
+        entries[profiler->nodes[i].function]|=profiler->nodes[i].interrupt ? 2 : 1;
+    }
+
+    fprintf(out, "\n      cycles      %%      count  address  instruction\n");
+
+    int gap=0;
+    for(int addr=0; addr<0x10000; ){
+        if(!profiler->pc_count[addr]){
+            gap=1;
+            addr++;
+            continue;
+        }
+
+        if(entries[addr]){
+            fprintf(out, "\n%s_%04x:\n", (entries[addr] & 1) ? "SUB" : "INT", addr);
+        }
+        else if(gap){
+            fprintf(out, "         ...\n");
+        }
+        gap=0;
+
+        //Addresses past the end of memory are mirrors
+        uint8_t bytes[3];
+        char text[32];
+        for(int k=0; k<3; k++){
+            bytes[k]=mem[(addr+k) % mem_size];
+        }
+        int length=i8080_disasm(text, sizeof(text), bytes, sizeof(bytes), 0);
+
+        fprintf(out, "%12llu %6.2f %10llu     %04x  %s\n", (unsigned long long)profiler->pc_cycles[addr],
+                100.0 * profiler->pc_cycles[addr] / total, (unsigned long long)profiler->pc_count[addr], addr, text);
+
+        addr+=length;
+    }
+
+    free(entries);
+    free(subtree);
+    free(function_of);
+    free(index_of);
+    free(functions);
+}
+
+int profiler_save(profiler_t* profiler, const char* prefix, const uint8_t* mem, int mem_size){
+    char path[4096];
+
+    snprintf(path, sizeof(path), "%s.folded", prefix);
+    FILE* folded=fopen(path, "w");
+    if(!folded){
+        printf("Cannot create profile %s\n", path);
+        return -1;
+    }
+    profiler_write_folded(profiler, folded);
+    fclose(folded);
+
+    snprintf(path, sizeof(path), "%s.txt", prefix);
+    FILE* report=fopen(path, "w");
+    if(!report){
+        printf("Cannot create profile %s\n", path);
+        return -1;
+    }
+    profiler_write_report(profiler, report, mem, mem_size);
+    fclose(report);
+
+    return 0;
+}
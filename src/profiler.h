@@ -0,0 +1,90 @@
+#ifndef profiler_H
+#define profiler_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "i8080_cpu.h"
+#include "i8080_opcodes.h"
+
+#define PROFILER_MAX_DEPTH	256		//Deeper calls are charged to the frame that made them
+#define PROFILER_MAX_NODES	65536		//Distinct call paths, later new ones go to their caller
+#define PROFILER_HASH_SIZE	(2 * PROFILER_MAX_NODES)
+
+/*One node per distinct call path (calling context tree). Node 0 is the code that is
+not inside any tracked call, reported as "main"*/
+typedef struct{
+    uint32_t parent;
+    uint16_t function;		//Entry address
+    uint8_t interrupt;		//Entered by an interrupt rather than CALL/RST
+    uint64_t cycles;		//Exclusive cycles spent in this path
+    uint64_t calls;
+} profiler_node_t;
+
+typedef struct{
+    uint32_t node;
+    uint16_t sp;		//SP just after the return address was pushed
+} profiler_frame_t;
+
+/*Guest call-graph profiler. CALL, RST and interrupt entry push a frame on a shadow
+stack and RET pops it, matched by SP so code that drops or fakes return addresses
+does not unbalance it. Every instruction's cycles are charged to its address and to
+the current call path, from which exclusive and inclusive cycles per function are
+worked out when reporting*/
+typedef struct profiler{
+    profiler_node_t* nodes;
+    int num_nodes;
+    uint32_t* hash;		//(parent, function, interrupt) -> node index + 1, 0 when empty
+
+    profiler_frame_t stack[PROFILER_MAX_DEPTH];
+    int depth;
+
+    uint64_t* pc_cycles;	//Cycles per address
+    uint64_t* pc_count;		//Executions per address
+    uint64_t total_cycles;
+
+    uint64_t dropped_calls;	//Calls that found the stack or the node table full
+} profiler_t;
+
+profiler_t* profiler_init();
+
+void profiler_destroy(profiler_t* profiler);
+
+void profiler_enter(profiler_t* profiler, uint16_t function, uint16_t sp, int interrupt);
+
+//A return popped the address at sp
+void profiler_leave(profiler_t* profiler, uint16_t sp);
+
+//An interrupt pushed the return address at sp and jumped to vector, taking cycles to do so
+void profiler_interrupt(profiler_t* profiler, uint16_t vector, uint16_t sp, int cycles);
+
+//Accounts one executed instruction, cpu holds the state after it ran
+static inline void profiler_step(profiler_t* profiler, uint16_t pc, uint8_t opcode, uint16_t sp_before,
+                                 const i8080* cpu, int cycles){
+    int flow=i8080_opcodes[opcode].flow;
+
+    profiler->pc_cycles[pc]+=cycles;
+    profiler->pc_count[pc]++;
+    profiler->nodes[profiler->stack[profiler->depth-1].node].cycles+=cycles;
+    profiler->total_cycles+=cycles;
+
+    //Conditional calls and returns only count when taken, which shows in SP
+    if((flow==FLOW_CALL || flow==FLOW_RST) && cpu->SP==(uint16_t)(sp_before-2)){
+        profiler_enter(profiler, cpu->PC, cpu->SP, 0);
+    }
+    else if((flow==FLOW_RET || flow==FLOW_RET_COND) && cpu->SP==(uint16_t)(sp_before+2)){
+        profiler_leave(profiler, sp_before);
+    }
+}
+
+//Writes one line per call path with cycles, e.g. "main;SUB_0010;SUB_1400 1234", for flamegraph.pl
+void profiler_write_folded(profiler_t* profiler, FILE* out);
+
+/*Writes a table of inclusive and exclusive cycles and calls per function, followed by
+a disassembly of all executed code annotated with the cycles spent on each instruction*/
+void profiler_write_report(profiler_t* profiler, FILE* out, const uint8_t* mem, int mem_size);
+
+//Writes prefix.folded and prefix.txt, returns -1 if either cannot be created
+int profiler_save(profiler_t* profiler, const char* prefix, const uint8_t* mem, int mem_size);
+
+#endif
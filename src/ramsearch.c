@@ -0,0 +1,147 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "ramsearch.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+ramsearch_t* ramsearch_init(int num_instances){
+    ramsearch_t* search=aligned_alloc(_Alignof(ramsearch_t), sizeof(ramsearch_t));
+    memset(search, 0, sizeof(ramsearch_t));
+
+    search->num_instances=num_instances;
+    search->previous=calloc(num_instances, RAMSEARCH_SIZE);
+
+    return search;
+}
+
+void ramsearch_destroy(ramsearch_t* search){
+    free(search->previous);
+    free(search);
+}
+
+void ramsearch_snapshot(ramsearch_t* search, machine_t* const machines[]){
+    for(int i=0; i<search->num_instances; i++){
+        memcpy(search->previous[i], machines[i]->machine_mem+RAMSEARCH_START, RAMSEARCH_SIZE);
+    }
+}
+
+void ramsearch_reset(ramsearch_t* search, machine_t* const machines[]){
+    memset(search->candidates, 0xFF, RAMSEARCH_SIZE);
+    search->num_candidates=RAMSEARCH_SIZE;
+
+    ramsearch_snapshot(search, machines);
+}
+
+#ifdef __SSE2__
+//0xFF in every byte where predicate holds for now against operand, all unsigned
+static inline __m128i predicate_mask(int predicate, __m128i now, __m128i operand){
+    __m128i ones=_mm_set1_epi8(-1);
+
+    switch(predicate){
+        case RAMSEARCH_EQUAL: return _mm_cmpeq_epi8(now, operand);
+        case RAMSEARCH_NOT_EQUAL: return _mm_xor_si128(_mm_cmpeq_epi8(now, operand), ones);
+        //now>operand exactly when max(now, operand) is not operand, and the other way round for <
+        case RAMSEARCH_GREATER: return _mm_xor_si128(_mm_cmpeq_epi8(_mm_max_epu8(now, operand), operand), ones);
+        default: return _mm_xor_si128(_mm_cmpeq_epi8(_mm_min_epu8(now, operand), operand), ones);
+    }
+}
+#endif
+
+static inline int predicate_holds(int predicate, uint8_t now, uint8_t operand){
+    switch(predicate){
+        case RAMSEARCH_EQUAL: return now==operand;
+        case RAMSEARCH_NOT_EQUAL: return now!=operand;
+        case RAMSEARCH_GREATER: return now>operand;
+        default: return now<operand;
+    }
+}
+
+//Clears the candidates of one machine's RAM that fail predicate
+static void filter_instance(uint8_t* candidates, const uint8_t* ram, const uint8_t* previous,
+                            int predicate, int value){
+#ifdef __SSE2__
+    __m128i constant=_mm_set1_epi8((char)value);
+
+    for(int i=0; i<RAMSEARCH_SIZE; i+=16){
+        __m128i now=_mm_loadu_si128((const __m128i*)(ram+i));
+        __m128i operand=(value<0) ? _mm_loadu_si128((const __m128i*)(previous+i)) : constant;
+        __m128i* candidate=(__m128i*)(candidates+i);
+
+        *candidate=_mm_and_si128(*candidate, predicate_mask(predicate, now, operand));
+    }
+#else
+    for(int i=0; i<RAMSEARCH_SIZE; i++){
+        uint8_t operand=(value<0) ? previous[i] : (uint8_t)value;
+
+        if(!predicate_holds(predicate, ram[i], operand)){
+            candidates[i]=0;
+        }
+    }
+#endif
+}
+
+static int count_candidates(const uint8_t* candidates){
+    int count=0;
+
+#ifdef __SSE2__
+    for(int i=0; i<RAMSEARCH_SIZE; i+=16){
+        count+=__builtin_popcount(_mm_movemask_epi8(_mm_load_si128((const __m128i*)(candidates+i))));
+    }
+#else
+    for(int i=0; i<RAMSEARCH_SIZE; i++){
+        count+=candidates[i]!=0;
+    }
+#endif
+
+    return count;
+}
+
+int ramsearch_filter(ramsearch_t* search, machine_t* const machines[], int predicate, int value){
+    if(value>0xFF){
+        value=0xFF;
+    }
+
+    for(int i=0; i<search->num_instances; i++){
+        filter_instance(search->candidates, machines[i]->machine_mem+RAMSEARCH_START, search->previous[i],
+                        predicate, value);
+    }
+
+    search->num_candidates=count_candidates(search->candidates);
+    ramsearch_snapshot(search, machines);
+
+    return search->num_candidates;
+}
+
+int ramsearch_next(const ramsearch_t* search, int addr){
+    for(int i=addr-RAMSEARCH_START; i<RAMSEARCH_SIZE; i++){
+        if(i>=0 && search->candidates[i]){
+            return RAMSEARCH_START+i;
+        }
+    }
+
+    return -1;
+}
+
+int ramsearch_watch(ramsearch_t* search, int addr, int size){
+    if(search->num_watches==RAMSEARCH_MAX_WATCHES || addr<0 || addr+size>MACHINE_MEM_SIZE){
+        return -1;
+    }
+
+    search->watches[search->num_watches].addr=addr;
+    search->watches[search->num_watches].size=(size==2) ? 2 : 1;
+    search->num_watches++;
+
+    return 0;
+}
+
+void ramsearch_unwatch(ramsearch_t* search, int addr){
+    for(int i=0; i<search->num_watches; i++){
+        if(search->watches[i].addr==addr){
+            search->watches[i]=search->watches[--search->num_watches];
+            return;
+        }
+    }
+}
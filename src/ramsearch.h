@@ -0,0 +1,66 @@
+#ifndef ramsearch_H
+#define ramsearch_H
+
+#include <stdint.h>
+
+#include "machine.h"
+
+#define RAMSEARCH_START		0x2000		//Work RAM and VRAM, everything after the ROM
+#define RAMSEARCH_SIZE		(MACHINE_MEM_SIZE - RAMSEARCH_START)
+#define RAMSEARCH_MAX_WATCHES	32
+
+/*Predicates compare the current value of each address with its value at the last
+snapshot, or with a constant*/
+enum ramsearch_predicates{
+    RAMSEARCH_EQUAL,		//Unchanged, or equal to the value
+    RAMSEARCH_NOT_EQUAL,	//Changed, or different from the value
+    RAMSEARCH_GREATER,		//Increased, or above the value (unsigned)
+    RAMSEARCH_LESS,		//Decreased, or below the value (unsigned)
+    RAMSEARCH_NUM_PREDICATES
+};
+
+typedef struct{
+    uint16_t addr;
+    uint8_t size;		//1 or 2 bytes, little-endian
+} ramsearch_watch_t;
+
+/*Cheat-finder style search over the RAM of one or more machines. An address stays a
+candidate only while the predicate holds on every machine, so running a few
+machines with different inputs narrows the search faster. Each filter is one
+vectorized pass over RAMSEARCH_SIZE bytes per machine*/
+typedef struct{
+    int num_instances;
+
+    uint8_t candidates[RAMSEARCH_SIZE] __attribute__((aligned(16)));	//0xFF for a candidate
+    int num_candidates;
+
+    uint8_t (*previous)[RAMSEARCH_SIZE];	//Last snapshot of each machine
+
+    ramsearch_watch_t watches[RAMSEARCH_MAX_WATCHES];
+    int num_watches;
+} ramsearch_t;
+
+ramsearch_t* ramsearch_init(int num_instances);
+
+void ramsearch_destroy(ramsearch_t* search);
+
+//Makes every address a candidate again and snapshots the machines
+void ramsearch_reset(ramsearch_t* search, machine_t* const machines[]);
+
+//Snapshots the machines without filtering
+void ramsearch_snapshot(ramsearch_t* search, machine_t* const machines[]);
+
+/*Drops the candidates for which predicate does not hold, against the last snapshot if
+value is negative or against value otherwise, then snapshots. Returns the number of
+candidates left*/
+int ramsearch_filter(ramsearch_t* search, machine_t* const machines[], int predicate, int value);
+
+//Returns the first candidate address at or after addr, or -1
+int ramsearch_next(const ramsearch_t* search, int addr);
+
+//Returns -1 if the list is full or addr is outside the machine
+int ramsearch_watch(ramsearch_t* search, int addr, int size);
+
+void ramsearch_unwatch(ramsearch_t* search, int addr);
+
+#endif
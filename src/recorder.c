@@ -0,0 +1,143 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "recorder.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+recorder_t* recorder_open(const char* path, const uint8_t overlay[SCREEN_HEIGHT / 8][3]){
+    async_writer_t* writer=async_writer_open(path, RECORDER_BUFFER_SIZE);
+
+    if(!writer){
+        return NULL;
+    }
+
+    recorder_t* recorder=calloc(1, sizeof(recorder_t));
+    recorder->writer=writer;
+
+    recorder_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, RECORDER_MAGIC, sizeof(header.magic));
+    header.version=RECORDER_VERSION;
+    header.width=SCREEN_WIDTH;
+    header.height=SCREEN_HEIGHT;
+    header.fps=FPS;
+    header.vram_size=VRAM_SIZE;
+    memcpy(header.overlay, overlay, sizeof(header.overlay));
+
+    async_writer_write(writer, &header, sizeof(header));
+
+    return recorder;
+}
+
+void recorder_close(recorder_t* recorder){
+    async_writer_close(recorder->writer);
+    free(recorder);
+}
+
+/*RLE codes the XOR delta between vram and previous into out and brings previous up
+to date, returns the encoded length. Both are read in one pass, so the delta itself
+is never stored*/
+static int encode_frame(uint8_t* out, uint8_t* previous, const uint8_t* vram){
+    int length=0;
+    int i=0;
+
+    while(i<VRAM_SIZE){
+        int start=i;
+
+        //Most of VRAM is unchanged, so skip it a vector at a time
+#ifdef __SSE2__
+        while(i+16<=VRAM_SIZE){
+            __m128i now=_mm_loadu_si128((const __m128i*)(vram+i));
+            __m128i before=_mm_loadu_si128((const __m128i*)(previous+i));
+            int changed=_mm_movemask_epi8(_mm_cmpeq_epi8(now, before)) ^ 0xFFFF;
+
+            if(changed){
+                i+=__builtin_ctz(changed);
+                break;
+            }
+            i+=16;
+        }
+#else
+        while(i+8<=VRAM_SIZE && memcmp(vram+i, previous+i, 8)==0){
+            i+=8;
+        }
+#endif
+        while(i<VRAM_SIZE && vram[i]==previous[i]){
+            i++;
+        }
+
+        //An unchanged frame is coded as an empty record
+        if(i==VRAM_SIZE && start==0){
+            return 0;
+        }
+
+        for(int run=i-start; run>0; run-=128){
+            out[length++]=(run>128 ? 128 : run)-1;
+        }
+
+        //Literals run until the next pair of unchanged bytes, a lone one is cheaper to copy
+        start=i;
+        uint8_t* literals=out+length+1;
+
+        while(i<VRAM_SIZE && i-start<128 &&
+              (vram[i]!=previous[i] || (i+1<VRAM_SIZE && vram[i+1]!=previous[i+1]))){
+            literals[i-start]=vram[i] ^ previous[i];
+            previous[i]=vram[i];
+            i++;
+        }
+
+        if(i>start){
+            out[length]=0x80+(i-start-1);
+            length+=1+i-start;
+        }
+    }
+
+    return length;
+}
+
+void recorder_frame(recorder_t* recorder, const uint8_t* vram){
+    recorder->num_frames++;
+
+    //Encode straight into the writer's buffer, then give back what was not used
+    uint8_t* record=async_writer_reserve(recorder->writer, sizeof(uint16_t) + RECORDER_MAX_FRAME);
+    uint16_t length=encode_frame(record+sizeof(uint16_t), recorder->previous, vram);
+
+    memcpy(record, &length, sizeof(length));
+    async_writer_unreserve(recorder->writer, RECORDER_MAX_FRAME-length);
+}
+
+int recorder_decode(uint8_t* vram, const uint8_t* record, int length){
+    int pos=0;
+    int i=0;
+
+    while(pos<length){
+        uint8_t control=record[pos++];
+
+        if(control<0x80){
+            i+=control+1;
+        }
+        else{
+            int count=control-0x7F;
+
+            if(pos+count>length || i+count>VRAM_SIZE){
+                return -1;
+            }
+
+            for(int j=0; j<count; j++){
+                vram[i+j]^=record[pos+j];
+            }
+
+            pos+=count;
+            i+=count;
+        }
+
+        if(i>VRAM_SIZE){
+            return -1;
+        }
+    }
+
+    return 0;
+}
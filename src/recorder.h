@@ -0,0 +1,51 @@
+#ifndef recorder_H
+#define recorder_H
+
+#include <stdint.h>
+
+#include "machine.h"
+#include "async_writer.h"
+
+#define RECORDER_MAGIC		"I80VIDEO"
+#define RECORDER_VERSION	1
+#define RECORDER_BUFFER_SIZE	(1024 * 1024)
+#define RECORDER_MAX_FRAME	(VRAM_SIZE + VRAM_SIZE / 128)	//Worst case encoded frame
+
+/*File header, followed by one record per emulated frame: a uint16_t length and that
+many bytes of RLE-coded XOR delta against the previous frame's VRAM (the first frame
+is against all zeros). A length of 0 means VRAM did not change.
+
+RLE control bytes 0x00-0x7F are followed by nothing and stand for 1-128 zero bytes,
+0x80-0xFF are followed by 1-128 literal bytes.
+
+VRAM is stored as the machine sees it: each 32-byte row is one screen column, bit 0
+of its first byte is the bottom pixel. overlay[band] is the colour of screen rows
+band*8 to band*8+7, counted from the top*/
+typedef struct{
+    char magic[8];
+    uint32_t version;
+    uint16_t width, height;		//Screen size in pixels, after rotation
+    uint16_t fps;
+    uint16_t vram_size;
+    uint8_t overlay[SCREEN_HEIGHT / 8][3];
+} recorder_header_t;
+
+typedef struct recorder{
+    async_writer_t* writer;
+    uint8_t previous[VRAM_SIZE];	//VRAM of the last recorded frame
+    uint64_t num_frames;
+} recorder_t;
+
+//Creates a recording, returns NULL if the file cannot be created
+recorder_t* recorder_open(const char* path, const uint8_t overlay[SCREEN_HEIGHT / 8][3]);
+
+void recorder_close(recorder_t* recorder);
+
+//Appends a frame, vram points at VRAM_SIZE bytes
+void recorder_frame(recorder_t* recorder, const uint8_t* vram);
+
+/*Applies one frame record of length bytes to vram (VRAM_SIZE bytes, holding the
+previous frame). Returns -1 if the record is corrupt*/
+int recorder_decode(uint8_t* vram, const uint8_t* record, int length);
+
+#endif
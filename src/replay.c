@@ -0,0 +1,122 @@
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "replay.h"
+
+replay_t* replay_create(const char* path){
+    FILE* fp=fopen(path, "wb");
+
+    if(!fp){
+        return NULL;
+    }
+
+    //The sample count is filled in by replay_close()
+    replay_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, REPLAY_MAGIC, sizeof(header.magic));
+    header.version=REPLAY_VERSION;
+    fwrite(&header, sizeof(header), 1, fp);
+
+    replay_t* replay=calloc(1, sizeof(replay_t));
+    replay->fp=fp;
+
+    return replay;
+}
+
+void replay_record(replay_t* replay, uint8_t in1, uint8_t in2){
+    replay_run_t* run=&replay->run;
+
+    if(run->count && (run->sample.in1!=in1 || run->sample.in2!=in2 || run->count==UINT16_MAX)){
+        fwrite(run, sizeof(replay_run_t), 1, replay->fp);
+        run->count=0;
+    }
+
+    run->sample.in1=in1;
+    run->sample.in2=in2;
+    run->count++;
+    replay->num_samples++;
+}
+
+replay_t* replay_load(const char* path){
+    FILE* fp=fopen(path, "rb");
+    replay_header_t header;
+
+    if(!fp){
+        printf("Cannot open replay %s\n", path);
+        return NULL;
+    }
+
+    if(fread(&header, sizeof(header), 1, fp)!=1 || memcmp(header.magic, REPLAY_MAGIC, sizeof(header.magic))!=0 ||
+       header.version!=REPLAY_VERSION){
+        printf("%s is not a version %d input replay\n", path, REPLAY_VERSION);
+        fclose(fp);
+        return NULL;
+    }
+
+    //Every run holds at most UINT16_MAX samples, which bounds the count a file of this size can hold
+    long start=ftell(fp);
+    fseek(fp, 0, SEEK_END);
+    size_t max_samples=(size_t)(ftell(fp)-start) / sizeof(replay_run_t) * UINT16_MAX;
+    fseek(fp, start, SEEK_SET);
+
+    if(header.num_samples>max_samples){
+        printf("%s is truncated\n", path);
+        fclose(fp);
+        return NULL;
+    }
+
+    replay_t* replay=calloc(1, sizeof(replay_t));
+    replay->samples=malloc(sizeof(replay_sample_t) * ((size_t)header.num_samples+1));
+
+    if(!replay->samples){
+        printf("Out of memory loading %s\n", path);
+        fclose(fp);
+        replay_close(replay);
+        return NULL;
+    }
+
+    replay_run_t run;
+    while(replay->num_samples<header.num_samples && fread(&run, sizeof(run), 1, fp)==1){
+        for(int i=0; i<run.count && replay->num_samples<header.num_samples; i++){
+            replay->samples[replay->num_samples++]=run.sample;
+        }
+    }
+
+    fclose(fp);
+
+    if(replay->num_samples<header.num_samples){
+        printf("%s is truncated\n", path);
+        replay_close(replay);
+        return NULL;
+    }
+
+    return replay;
+}
+
+void replay_close(replay_t* replay){
+    if(replay->fp){
+        if(replay->run.count){
+            fwrite(&replay->run, sizeof(replay_run_t), 1, replay->fp);
+        }
+
+        fseek(replay->fp, offsetof(replay_header_t, num_samples), SEEK_SET);
+        fwrite(&replay->num_samples, sizeof(replay->num_samples), 1, replay->fp);
+        fclose(replay->fp);
+    }
+
+    free(replay->samples);
+    free(replay);
+}
+
+void replay_run_frame(machine_t* machine, const replay_sample_t* samples){
+    machine->port_in1=samples[0].in1;
+    machine->port_in2=samples[0].in2;
+    int frame_cycles=machine_run_until(machine, 0, HALF_CYCLES_PER_FRAME);
+    generate_interrupt(machine, 1);
+
+    machine->port_in1=samples[1].in1;
+    machine->port_in2=samples[1].in2;
+    machine_run_until(machine, frame_cycles, CYCLES_PER_FRAME);
+    generate_interrupt(machine, 2);
+}
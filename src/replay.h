@@ -0,0 +1,57 @@
+#ifndef replay_H
+#define replay_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "machine.h"
+
+#define REPLAY_MAGIC		"I80INPUT"
+#define REPLAY_VERSION		1
+
+/*File header, followed by runs of identical input samples. There are two samples per
+frame, one before each half (where the front end reads the keyboard), so replaying
+them through replay_run_frame() on a machine started from power-on repeats the
+recorded session exactly*/
+typedef struct{
+    char magic[8];
+    uint32_t version;
+    uint32_t num_samples;
+} replay_header_t;
+
+typedef struct{
+    uint8_t in1, in2;		//Input ports 1 and 2
+} replay_sample_t;
+
+typedef struct{
+    uint16_t count;
+    replay_sample_t sample;
+} replay_run_t;
+
+typedef struct replay{
+    FILE* fp;			//Set while recording
+
+    //Recording: the run still being extended
+    replay_run_t run;
+    uint32_t num_samples;
+
+    //Playback: every sample of a loaded replay
+    replay_sample_t* samples;
+} replay_t;
+
+//Starts recording to path, returns NULL if it cannot be created
+replay_t* replay_create(const char* path);
+
+//Appends the input sample taken before the next half frame
+void replay_record(replay_t* replay, uint8_t in1, uint8_t in2);
+
+//Loads a whole replay, prints what is wrong and returns NULL if it cannot be read
+replay_t* replay_load(const char* path);
+
+//Finishes a recording, or frees a loaded replay
+void replay_close(replay_t* replay);
+
+//Runs one frame with inputs from samples[0] and samples[1]
+void replay_run_frame(machine_t* machine, const replay_sample_t* samples);
+
+#endif
@@ -0,0 +1,185 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "rom.h"
+
+static const rom_file_t invaders_files[]={
+    {"invaders.h", 0x0000, 0x0800, 0x734f5ad8},
+    {"invaders.g", 0x0800, 0x0800, 0x6bfaca4a},
+    {"invaders.f", 0x1000, 0x0800, 0x0ccead96},
+    {"invaders.e", 0x1800, 0x0800, 0x14e538b0}
+};
+
+const rom_set_t invaders_rom_set={"invaders", invaders_files, sizeof(invaders_files) / sizeof(invaders_files[0])};
+
+#ifdef EMBED_ROMS
+//Provided by rom_embedded.c, same order as the manifest
+void embedded_invaders_images(const uint8_t** images, size_t* sizes);
+#endif
+
+uint32_t rom_crc32(const uint8_t* data, size_t len){
+    static uint32_t table[256];
+
+    if(table[1]==0){
+        for(uint32_t i=0; i<256; i++){
+            uint32_t crc=i;
+            for(int bit=0; bit<8; bit++){
+                crc=(crc & 1) ? (crc>>1) ^ 0xEDB88320 : crc>>1;
+            }
+            table[i]=crc;
+        }
+    }
+
+    uint32_t crc=0xFFFFFFFF;
+    for(size_t i=0; i<len; i++){
+        crc=table[(crc ^ data[i]) & 0xFF] ^ (crc>>8);
+    }
+
+    return crc ^ 0xFFFFFFFF;
+}
+
+static int is_directory(const char* path){
+    struct stat st;
+
+    return stat(path, &st)==0 && S_ISDIR(st.st_mode);
+}
+
+int rom_find_dir(const char* dir, char* out, size_t out_len){
+    if(dir){
+        snprintf(out, out_len, "%s", dir);
+        return is_directory(out) ? 0 : -1;
+    }
+
+    if(is_directory("ROM")){
+        snprintf(out, out_len, "ROM");
+        return 0;
+    }
+
+    //The executable lives in bin/, the ROMs in ROM/ next to it
+    char exe[ROM_PATH_MAX];
+    ssize_t len=readlink("/proc/self/exe", exe, sizeof(exe)-1);
+
+    if(len>0){
+        exe[len]='\0';
+
+        char* slash=strrchr(exe, '/');
+        if(slash){
+            *slash='\0';
+            snprintf(out, out_len, "%s/../ROM", exe);
+            if(is_directory(out)){
+                return 0;
+            }
+        }
+    }
+
+    return -1;
+}
+
+const uint8_t* rom_map_file(const char* path, size_t* size, char* error, size_t error_len){
+    int fd=open(path, O_RDONLY);
+    struct stat st;
+
+    if(fd<0 || fstat(fd, &st)<0){
+        snprintf(error, error_len, "%s: %s", path, strerror(errno));
+        if(fd>=0) close(fd);
+        return NULL;
+    }
+
+    if(st.st_size==0){
+        snprintf(error, error_len, "%s: file is empty", path);
+        close(fd);
+        return NULL;
+    }
+
+    void* data=mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if(data==MAP_FAILED){
+        snprintf(error, error_len, "%s: %s", path, strerror(errno));
+        return NULL;
+    }
+
+    *size=st.st_size;
+
+    return data;
+}
+
+void rom_unmap_file(const uint8_t* data, size_t size){
+    munmap((void*)data, size);
+}
+
+//Checks one image against its manifest entry
+static int verify_image(const rom_file_t* file, const uint8_t* data, size_t size, size_t mem_size,
+                        char* error, size_t error_len){
+    if(size!=file->size){
+        snprintf(error, error_len, "%s: expected %u bytes, found %zu (%s)", file->name, file->size, size,
+                 size<file->size ? "truncated" : "wrong file");
+        return -1;
+    }
+
+    if((size_t)file->offset+file->size>mem_size){
+        snprintf(error, error_len, "%s: does not fit in memory at $%04x", file->name, file->offset);
+        return -1;
+    }
+
+    uint32_t crc=rom_crc32(data, size);
+    if(crc!=file->crc32){
+        snprintf(error, error_len, "%s: CRC32 is %08x, expected %08x (corrupt or wrong ROM version)",
+                 file->name, crc, file->crc32);
+        return -1;
+    }
+
+    return 0;
+}
+
+int rom_load_set(const rom_set_t* set, const char* dir, uint8_t* mem, size_t mem_size,
+                 char* error, size_t error_len){
+    const uint8_t* images[set->num_files];
+    size_t sizes[set->num_files];
+    int status=0;
+    int num_mapped=0;
+
+#ifdef EMBED_ROMS
+    (void)dir;
+
+    if(set!=&invaders_rom_set){
+        snprintf(error, error_len, "%s: not embedded in this build", set->name);
+        return -1;
+    }
+
+    embedded_invaders_images(images, sizes);
+#else
+    for(int i=0; i<set->num_files; i++){
+        char path[ROM_PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s", dir, set->files[i].name);
+
+        images[i]=rom_map_file(path, &sizes[i], error, error_len);
+        if(!images[i]){
+            status=-1;
+            break;
+        }
+        num_mapped++;
+    }
+#endif
+
+    //Verify everything first so a bad set never leaves memory half loaded
+    for(int i=0; i<set->num_files && status==0; i++){
+        status=verify_image(&set->files[i], images[i], sizes[i], mem_size, error, error_len);
+    }
+
+    for(int i=0; i<set->num_files && status==0; i++){
+        memcpy(&mem[set->files[i].offset], images[i], sizes[i]);
+    }
+
+    for(int i=0; i<num_mapped; i++){
+        rom_unmap_file(images[i], sizes[i]);
+    }
+
+    return status;
+}
@@ -0,0 +1,44 @@
+#ifndef rom_H
+#define rom_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ROM_PATH_MAX		512
+
+//One file of a ROM set and where it goes in the address space
+typedef struct{
+    const char* name;
+    uint16_t offset;
+    uint16_t size;
+    uint32_t crc32;
+} rom_file_t;
+
+typedef struct{
+    const char* name;
+    const rom_file_t* files;
+    int num_files;
+} rom_set_t;
+
+extern const rom_set_t invaders_rom_set;
+
+uint32_t rom_crc32(const uint8_t* data, size_t len);
+
+/*Finds the ROM directory: dir if given, else ./ROM, else ROM next to the executable's
+bin directory. Returns 0 and fills out, or -1 if none of them exists*/
+int rom_find_dir(const char* dir, char* out, size_t out_len);
+
+/*Loads every file of the set into mem after checking its size and CRC32. With
+EMBED_ROMS the images compiled into the executable are used and dir is ignored.
+Returns 0, or -1 with a description of the problem in error; mem is only written
+once the whole set has been verified*/
+int rom_load_set(const rom_set_t* set, const char* dir, uint8_t* mem, size_t mem_size,
+                 char* error, size_t error_len);
+
+/*Maps a whole file read-only. Returns NULL (with the reason in error) if it cannot be
+opened or is empty*/
+const uint8_t* rom_map_file(const char* path, size_t* size, char* error, size_t error_len);
+
+void rom_unmap_file(const uint8_t* data, size_t size);
+
+#endif
@@ -0,0 +1,46 @@
+#ifdef EMBED_ROMS
+
+#include <stddef.h>
+#include <stdint.h>
+
+void embedded_invaders_images(const uint8_t** images, size_t* sizes);
+
+/*ROM images compiled into the executable (make EMBED_ROMS=1). EMBED_ROM_DIR is set by
+the makefile*/
+
+#define EMBED_IMAGE(symbol, file) \
+    __asm__(".section .rodata\n" \
+            ".global " #symbol "\n" \
+            ".balign 16\n" \
+            #symbol ":\n" \
+            ".incbin \"" EMBED_ROM_DIR "/" file "\"\n" \
+            #symbol "_end:\n" \
+            ".previous\n"); \
+    extern const uint8_t symbol[]; \
+    extern const uint8_t symbol##_end[];
+
+EMBED_IMAGE(embedded_invaders_h, "invaders.h")
+EMBED_IMAGE(embedded_invaders_g, "invaders.g")
+EMBED_IMAGE(embedded_invaders_f, "invaders.f")
+EMBED_IMAGE(embedded_invaders_e, "invaders.e")
+
+//Fills in the images in manifest order; sizes come from the linker, so a file that
+//was truncated at build time is still rejected by the CRC check at startup
+void embedded_invaders_images(const uint8_t** images, size_t* sizes){
+    images[0]=embedded_invaders_h;
+    images[1]=embedded_invaders_g;
+    images[2]=embedded_invaders_f;
+    images[3]=embedded_invaders_e;
+
+    sizes[0]=embedded_invaders_h_end-embedded_invaders_h;
+    sizes[1]=embedded_invaders_g_end-embedded_invaders_g;
+    sizes[2]=embedded_invaders_f_end-embedded_invaders_f;
+    sizes[3]=embedded_invaders_e_end-embedded_invaders_e;
+}
+
+#else
+
+//Keeps the translation unit non-empty when ROMs are loaded from disk
+typedef int rom_embedded_unused;
+
+#endif
@@ -0,0 +1,200 @@
+#include "scaler.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SCALER_X86
+#include <immintrin.h>
+#endif
+
+//Halves every channel of count pixels
+static void dim_pixels(uint32_t* out, const uint32_t* in, int count){
+    int i=0;
+
+#ifdef __SSE2__
+    const __m128i mask=_mm_set1_epi32(0x007F7F7F);
+
+    for(; i+4<=count; i+=4){
+        __m128i px=_mm_loadu_si128((const __m128i*)(in+i));
+        _mm_storeu_si128((__m128i*)(out+i), _mm_and_si128(_mm_srli_epi32(px, 1), mask));
+    }
+#endif
+
+    for(; i<count; i++){
+        out[i]=(in[i]>>1) & 0x007F7F7F;
+    }
+}
+
+//Each channel of the afterglow becomes the brighter of the new pixel and half its old value
+static void phosphor_pixels(uint32_t* row, uint32_t* afterglow, int count){
+    int i=0;
+
+#ifdef __SSE2__
+    const __m128i mask=_mm_set1_epi32(0x007F7F7F);
+
+    for(; i+4<=count; i+=4){
+        __m128i glow=_mm_and_si128(_mm_srli_epi32(_mm_loadu_si128((const __m128i*)(afterglow+i)), 1), mask);
+        __m128i px=_mm_max_epu8(_mm_loadu_si128((const __m128i*)(row+i)), glow);
+        _mm_storeu_si128((__m128i*)(afterglow+i), px);
+        _mm_storeu_si128((__m128i*)(row+i), px);
+    }
+#endif
+
+    for(; i<count; i++){
+        uint32_t glow=(afterglow[i]>>1) & 0x007F7F7F;
+        uint32_t px=row[i];
+
+        for(int shift=0; shift<24; shift+=8){
+            if(((glow>>shift) & 0xFF) > ((px>>shift) & 0xFF)){
+                px=(px & ~(0xFFu<<shift)) | (glow & (0xFFu<<shift));
+            }
+        }
+
+        afterglow[i]=px;
+        row[i]=px;
+    }
+}
+
+static void scale_row_scalar(uint32_t* out, const uint32_t* in, int first, int last, int scale){
+    for(int x=first; x<last; x++){
+        for(int i=0; i<scale; i++){
+            out[x*scale+i]=in[x];
+        }
+    }
+}
+
+#ifdef SCALER_X86
+//Broadcasts each pixel and stores it once or twice, the next pixel overwrites the excess
+static void scale_row_sse2(uint32_t* out, const uint32_t* in, int first, int last, int scale){
+    for(int x=first; x<last; x++){
+        __m128i px=_mm_set1_epi32(in[x]);
+        uint32_t* dst=out+x*scale;
+
+        _mm_storeu_si128((__m128i*)dst, px);
+        if(scale>4){
+            _mm_storeu_si128((__m128i*)(dst+scale-4), px);
+        }
+    }
+}
+
+/*Output pixel o comes from input pixel o/scale. Eight output pixels starting at
+o=scale*x+phase come from inputs x..x+7, picked by permute_index[scale][phase].
+The next eight start permute_step[scale][phase] inputs further on*/
+static int32_t permute_index[SCALER_MAX_SCALE+1][SCALER_MAX_SCALE][8] __attribute__((aligned(32)));
+static uint8_t permute_step[SCALER_MAX_SCALE+1][SCALER_MAX_SCALE];
+
+__attribute__((target("avx2")))
+static void scale_row_avx2(uint32_t* out, const uint32_t* in, int first, int last, int scale){
+    int x=first;
+    int phase=0;
+
+    for(int o=first*scale; o<last*scale; o+=8){
+        __m256i src=_mm256_loadu_si256((const __m256i*)(in+x));
+        __m256i index=_mm256_load_si256((const __m256i*)permute_index[scale][phase]);
+        _mm256_storeu_si256((__m256i*)(out+o), _mm256_permutevar8x32_epi32(src, index));
+
+        int step=permute_step[scale][phase];
+        x+=step;
+        phase+=8-step*scale;
+    }
+}
+#endif
+
+scaler_t* scaler_init(int scale, int scanlines, int phosphor){
+    if(scale<SCALER_MIN_SCALE || scale>SCALER_MAX_SCALE){
+        return NULL;
+    }
+
+    scaler_t* scaler=calloc(1, sizeof(scaler_t));
+    if(!scaler){
+        return NULL;
+    }
+
+    //Rows are a whole number of cache lines, and the vector loads may read past the end of the source row
+    const int align_pixels=SCALER_ALIGN / sizeof(uint32_t);
+    size_t row_size=sizeof(uint32_t) * ((SCREEN_WIDTH + SCALER_PADDING + align_pixels-1) / align_pixels * align_pixels);
+
+    scaler->scale=scale;
+    scaler->scanlines=scanlines;
+    scaler->phosphor=phosphor;
+    scaler->width=SCREEN_WIDTH * scale;
+    scaler->height=SCREEN_HEIGHT * scale;
+    scaler->pitch=(scaler->width + SCALER_PADDING + align_pixels-1) / align_pixels * align_pixels;
+
+    scaler->pixels=aligned_alloc(SCALER_ALIGN, sizeof(uint32_t) * scaler->pitch * scaler->height);
+    scaler->row=aligned_alloc(SCALER_ALIGN, row_size);
+    scaler->afterglow=calloc(SCREEN_HEIGHT * SCREEN_WIDTH, sizeof(uint32_t));
+
+    if(!scaler->pixels || !scaler->row || !scaler->afterglow){
+        scaler_destroy(scaler);
+        return NULL;
+    }
+
+    memset(scaler->pixels, 0, sizeof(uint32_t) * scaler->pitch * scaler->height);
+    memset(scaler->row, 0, row_size);
+
+    scaler->engine="scalar";
+    scaler->scale_row=scale_row_scalar;
+
+#ifdef SCALER_X86
+    scaler->engine="sse2";
+    scaler->scale_row=scale_row_sse2;
+
+    if(__builtin_cpu_supports("avx2")){
+        for(int phase=0; phase<scale; phase++){
+            for(int i=0; i<8; i++){
+                permute_index[scale][phase][i]=(phase+i) / scale;
+            }
+            permute_step[scale][phase]=(phase+8) / scale;
+        }
+
+        scaler->engine="avx2";
+        scaler->scale_row=scale_row_avx2;
+    }
+#endif
+
+    return scaler;
+}
+
+void scaler_destroy(scaler_t* scaler){
+    free(scaler->pixels);
+    free(scaler->row);
+    free(scaler->afterglow);
+    free(scaler);
+}
+
+void scaler_run(scaler_t* scaler, const uint8_t screen[SCREEN_HEIGHT][SCREEN_WIDTH][3],
+                int first_column, int last_column){
+    int scale=scaler->scale;
+    int count=(last_column-first_column) * scale;     //Output pixels per row
+
+    for(int y=0; y<SCREEN_HEIGHT; y++){
+        uint32_t* row=scaler->row;
+
+        for(int x=first_column; x<last_column; x++){
+            const uint8_t* pixel=screen[y][x];
+            row[x]=(pixel[R]<<16) | (pixel[G]<<8) | pixel[B];
+        }
+
+        if(scaler->phosphor){
+            phosphor_pixels(row+first_column, scaler->afterglow+y*SCREEN_WIDTH+first_column,
+                            last_column-first_column);
+        }
+
+        //The first output row is scaled, the rest are copies of it
+        uint32_t* out=scaler->pixels + y*scale*scaler->pitch;
+        scaler->scale_row(out, row, first_column, last_column, scale);
+
+        uint32_t* first=out + first_column*scale;
+        for(int i=1; i<scale; i++){
+            uint32_t* copy=first + i*scaler->pitch;
+
+            if(scaler->scanlines && i==scale-1){
+                dim_pixels(copy, first, count);
+            }
+            else{
+                memcpy(copy, first, sizeof(uint32_t) * count);
+            }
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef scaler_H
+#define scaler_H
+
+#include "machine.h"
+#include <stdint.h>
+
+#define SCALER_MIN_SCALE		2
+#define SCALER_MAX_SCALE		6
+#define SCALER_PADDING			8		//Pixels past the end of each output row that vector stores may overwrite
+#define SCALER_ALIGN			64		//Byte alignment of every row, a cache line
+
+/*Integer upscaler with optional CRT effects, run on the CPU after the screen buffer has
+been converted. The output is XRGB8888 (0x00RRGGBB) so each pixel is one 32-bit lane.
+Scanlines dim the last output row of every source row to half brightness. Phosphor
+keeps a half-brightness afterglow of the previous frame, so flickering sprites don't
+vanish between frames*/
+typedef struct{
+    int scale;
+    int scanlines;
+    int phosphor;
+
+    int width, height;		//Output size in pixels
+    int pitch;			//Output row length in pixels, including SCALER_PADDING and rounded up to SCALER_ALIGN
+    uint32_t* pixels;		//height rows of pitch pixels
+
+    uint32_t* row;		//The source row being scaled, as XRGB8888
+    uint32_t* afterglow;	//[SCREEN_HEIGHT][SCREEN_WIDTH] phosphor brightness
+
+    const char* engine;		//Name of the row scaling kernel in use
+    void (*scale_row)(uint32_t* out, const uint32_t* in, int first, int last, int scale);
+} scaler_t;
+
+//Returns NULL if scale is not within SCALER_MIN_SCALE-SCALER_MAX_SCALE or the buffers cannot be allocated
+scaler_t* scaler_init(int scale, int scanlines, int phosphor);
+
+void scaler_destroy(scaler_t* scaler);
+
+//Scales screen columns [first_column, last_column) of the screen buffer into pixels
+void scaler_run(scaler_t* scaler, const uint8_t screen[SCREEN_HEIGHT][SCREEN_WIDTH][3],
+                int first_column, int last_column);
+
+#endif
@@ -0,0 +1,30 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace.h"
+
+trace_t* trace_open(const char* path){
+    async_writer_t* writer=async_writer_open(path, TRACE_BUFFER_SIZE);
+
+    if(!writer){
+        return NULL;
+    }
+
+    trace_t* trace=calloc(1, sizeof(trace_t));
+    trace->writer=writer;
+
+    trace_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.version=TRACE_VERSION;
+    header.record_size=sizeof(trace_record_t);
+
+    async_writer_write(writer, &header, sizeof(header));
+
+    return trace;
+}
+
+void trace_close(trace_t* trace){
+    async_writer_close(trace->writer);
+    free(trace);
+}
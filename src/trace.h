@@ -0,0 +1,67 @@
+#ifndef trace_H
+#define trace_H
+
+#include <stdint.h>
+
+#include "i8080_cpu.h"
+#include "async_writer.h"
+
+#define TRACE_MAGIC		"I80TRACE"
+#define TRACE_VERSION		1
+#define TRACE_BUFFER_SIZE	(16 * 1024 * 1024)
+
+#define TRACE_IE		0x01		//trace_record_t.flags: interrupts were enabled
+
+//File header, followed by a flat array of trace_record_t
+typedef struct{
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+} trace_header_t;
+
+//CPU state before one instruction executes. Fixed size so traces can be indexed and diffed directly
+typedef struct{
+    uint32_t cycle;         //Low 32 bits of the CPU cycle counter
+    uint16_t pc;
+    uint16_t sp;
+    uint8_t opcode;
+    uint8_t operands[2];
+    uint8_t psw;
+    uint8_t a, b, c, d, e, h, l;
+    uint8_t flags;
+} trace_record_t;
+
+typedef struct{
+    async_writer_t* writer;
+    uint64_t num_records;
+} trace_t;
+
+//Creates a trace file, returns NULL if it cannot be created
+trace_t* trace_open(const char* path);
+
+void trace_close(trace_t* trace);
+
+//Appends the state of the CPU before it executes the instruction at PC
+static inline void trace_instruction(trace_t* trace, i8080* cpu){
+    trace_record_t* record=async_writer_reserve(trace->writer, sizeof(trace_record_t));
+
+    record->cycle=cpu->instruction_cycles;
+    record->pc=cpu->PC;
+    record->sp=cpu->SP;
+    record->opcode=cpu->memory[cpu->PC & cpu->address_mask];
+    record->operands[0]=cpu->memory[(cpu->PC+1) & cpu->address_mask];
+    record->operands[1]=cpu->memory[(cpu->PC+2) & cpu->address_mask];
+    record->psw=i8080_get_psw(cpu);
+    record->a=cpu->A;
+    record->b=cpu->B;
+    record->c=cpu->C;
+    record->d=cpu->D;
+    record->e=cpu->E;
+    record->h=cpu->H;
+    record->l=cpu->L;
+    record->flags=cpu->interrupt_enable ? TRACE_IE : 0;
+
+    trace->num_records++;
+}
+
+#endif
@@ -0,0 +1,698 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "i8080_opcodes.h"
+
+#define MAX_LINE		512
+#define MAX_OPERANDS		64
+#define MAX_SYMBOLS		4096
+#define MAX_SYMBOL_LEN		32
+#define MEM_SIZE		0x10000
+
+/*Two-pass 8080 assembler. Instructions are encoded from the same opcode table the
+disassembler uses, so the listing written by bin/disasm assembles back to the ROM.
+
+Usage: asm8080 [-o output] [-c name] file.asm
+Writes the bytes from the lowest to the highest address assembled as a raw binary,
+or with -c as a C array called name. Output goes to stdout without -o
+
+Syntax:
+    label:  MNEMONIC operand,operand    ; comment
+    name    EQU expression
+    ORG expression, DB values/'strings', DW values, DS count, END
+Numbers can be decimal, 0x1f, $1f, 1fH or 101B. $ on its own is the address of
+the current line, 'c' is a character constant and a leading # is ignored, so
+immediate operands may be written as #$12 like the disassembler does.
+Operators: + - * / % & | ^ << >> ~ and parentheses, with C precedence*/
+
+typedef struct{
+    char name[MAX_SYMBOL_LEN+1];
+    int value;
+} symbol_t;
+
+typedef struct{
+    const char* file;
+    int line;
+    int pass;
+    int pc;
+
+    symbol_t symbols[MAX_SYMBOLS];
+    int num_symbols;
+
+    uint8_t memory[MEM_SIZE];
+    int low, high;      //Range of addresses written in pass 2, high is exclusive
+} assembler_t;
+
+//Result of evaluating an expression: undefined is set if a symbol is not known yet
+typedef struct{
+    const char* pos;
+    int undefined;
+} expr_t;
+
+static void error(assembler_t* as, const char* msg, const char* detail){
+    fprintf(stderr, "%s:%d: %s%s%s\n", as->file, as->line, msg, detail ? ": " : "", detail ? detail : "");
+    exit(1);
+}
+
+static int is_ident_start(char c){
+    return isalpha((unsigned char)c) || c=='_' || c=='.' || c=='?' || c=='@';
+}
+
+static int is_ident_char(char c){
+    return is_ident_start(c) || isdigit((unsigned char)c);
+}
+
+static const char* skip_space(const char* s){
+    while(*s==' ' || *s=='\t'){
+        s++;
+    }
+
+    return s;
+}
+
+static symbol_t* find_symbol(assembler_t* as, const char* name){
+    for(int i=0; i<as->num_symbols; i++){
+        if(strcmp(as->symbols[i].name, name)==0){
+            return &as->symbols[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void define_symbol(assembler_t* as, const char* name, int value){
+    symbol_t* sym=find_symbol(as, name);
+
+    if(as->pass==2){
+        //Addresses can only differ between passes if sizing depended on a forward reference
+        if(sym && sym->value!=value){
+            error(as, "Symbol changed value between passes", name);
+        }
+        return;
+    }
+
+    if(sym){
+        error(as, "Symbol defined twice", name);
+    }
+    if(as->num_symbols==MAX_SYMBOLS){
+        error(as, "Too many symbols", NULL);
+    }
+
+    sym=&as->symbols[as->num_symbols++];
+    snprintf(sym->name, sizeof(sym->name), "%s", name);
+    sym->value=value;
+}
+
+//Reads an identifier into buf, truncating it to MAX_SYMBOL_LEN
+static const char* read_ident(const char* s, char* buf){
+    int len=0;
+
+    while(is_ident_char(*s)){
+        if(len<MAX_SYMBOL_LEN){
+            buf[len++]=*s;
+        }
+        s++;
+    }
+    buf[len]='\0';
+
+    return s;
+}
+
+static int digit_value(char c){
+    if(isdigit((unsigned char)c)){
+        return c-'0';
+    }
+
+    return tolower((unsigned char)c)-'a'+10;
+}
+
+static int parse_number(assembler_t* as, expr_t* e){
+    const char* s=e->pos;
+    const char* end=s;
+    int base=10;
+    int value=0;
+
+    while(isalnum((unsigned char)*end)){
+        end++;
+    }
+    e->pos=end;
+
+    if(s[0]=='0' && (s[1]=='x' || s[1]=='X')){
+        base=16;
+        s+=2;
+    }
+    else if(end[-1]=='h' || end[-1]=='H'){
+        base=16;
+        end--;
+    }
+    else if((end[-1]=='b' || end[-1]=='B') && strspn(s, "01")==(size_t)(end-s-1)){
+        base=2;
+        end--;
+    }
+
+    if(s==end){
+        error(as, "Bad number", NULL);
+    }
+
+    for(; s<end; s++){
+        if(!isxdigit((unsigned char)*s) || digit_value(*s)>=base){
+            error(as, "Bad digit in number", NULL);
+        }
+        value=value * base+digit_value(*s);
+    }
+
+    return value;
+}
+
+static int parse_expr(assembler_t* as, expr_t* e);
+
+static int parse_primary(assembler_t* as, expr_t* e){
+    e->pos=skip_space(e->pos);
+    const char* s=e->pos;
+
+    if(*s=='#'){
+        e->pos++;
+        return parse_primary(as, e);
+    }
+    if(*s=='('){
+        e->pos++;
+        int value=parse_expr(as, e);
+        e->pos=skip_space(e->pos);
+        if(*e->pos!=')'){
+            error(as, "Missing )", NULL);
+        }
+        e->pos++;
+        return value;
+    }
+    if(*s=='-'){
+        e->pos++;
+        return -parse_primary(as, e);
+    }
+    if(*s=='+'){
+        e->pos++;
+        return parse_primary(as, e);
+    }
+    if(*s=='~'){
+        e->pos++;
+        return ~parse_primary(as, e);
+    }
+    if(*s=='\'' && s[1] && s[2]=='\''){
+        e->pos+=3;
+        return (uint8_t)s[1];
+    }
+    if(*s=='$'){
+        if(isxdigit((unsigned char)s[1])){
+            int value=0;
+            for(s++; isxdigit((unsigned char)*s); s++){
+                value=value * 16+digit_value(*s);
+            }
+            e->pos=s;
+            return value;
+        }
+        e->pos++;
+        return as->pc;
+    }
+    if(isdigit((unsigned char)*s)){
+        return parse_number(as, e);
+    }
+    if(is_ident_start(*s)){
+        char name[MAX_SYMBOL_LEN+1];
+        e->pos=read_ident(s, name);
+
+        symbol_t* sym=find_symbol(as, name);
+        if(!sym){
+            if(as->pass==2){
+                error(as, "Undefined symbol", name);
+            }
+            e->undefined=1;
+            return 0;
+        }
+        return sym->value;
+    }
+
+    error(as, "Bad expression", s);
+    return 0;
+}
+
+//Binary operators by precedence level, lowest first
+static int parse_binary(assembler_t* as, expr_t* e, int level){
+    static const char* levels[][3]={{"|"}, {"^"}, {"&"}, {"<<", ">>"}, {"+", "-"}, {"*", "/", "%"}};
+
+    if(level==(int)(sizeof(levels) / sizeof(levels[0]))){
+        return parse_primary(as, e);
+    }
+
+    int value=parse_binary(as, e, level+1);
+
+    for(;;){
+        const char* op=NULL;
+
+        e->pos=skip_space(e->pos);
+        for(int i=0; i<3 && levels[level][i]; i++){
+            if(strncmp(e->pos, levels[level][i], strlen(levels[level][i]))==0){
+                op=levels[level][i];
+            }
+        }
+        if(!op){
+            return value;
+        }
+
+        e->pos+=strlen(op);
+        int rhs=parse_binary(as, e, level+1);
+
+        switch(op[0]){
+            case '|': value|=rhs; break;
+            case '^': value^=rhs; break;
+            case '&': value&=rhs; break;
+            case '<': value<<=rhs; break;
+            case '>': value>>=rhs; break;
+            case '+': value+=rhs; break;
+            case '-': value-=rhs; break;
+            case '*': value*=rhs; break;
+            case '/':
+            case '%':
+                if(rhs==0){
+                    if(e->undefined){
+                        return 0;
+                    }
+                    error(as, "Division by zero", NULL);
+                }
+                value=op[0]=='/' ? value / rhs : value % rhs;
+                break;
+        }
+    }
+}
+
+static int parse_expr(assembler_t* as, expr_t* e){
+    return parse_binary(as, e, 0);
+}
+
+//Evaluates a whole operand. Values needed to lay out the program must be known in pass 1
+static int eval(assembler_t* as, const char* text, int must_be_defined){
+    expr_t e={text, 0};
+    int value=parse_expr(as, &e);
+
+    if(*skip_space(e.pos)){
+        error(as, "Junk after expression", e.pos);
+    }
+    if(e.undefined && must_be_defined){
+        error(as, "Expression uses a symbol defined later", text);
+    }
+
+    return value;
+}
+
+static void emit(assembler_t* as, uint8_t byte){
+    if(as->pc>=MEM_SIZE){
+        error(as, "Program runs past $ffff", NULL);
+    }
+
+    if(as->pass==2){
+        as->memory[as->pc]=byte;
+        if(as->pc<as->low){
+            as->low=as->pc;
+        }
+        if(as->pc+1>as->high){
+            as->high=as->pc+1;
+        }
+    }
+
+    as->pc++;
+}
+
+static void emit_value(assembler_t* as, int value, int size){
+    if(as->pass==2 && (value<-(1<<(size * 8-1)) || value>=(1<<(size * 8)))){
+        error(as, size==1 ? "Value does not fit in a byte" : "Value does not fit in a word", NULL);
+    }
+
+    emit(as, value & 0xFF);
+    if(size==2){
+        emit(as, (value>>8) & 0xFF);
+    }
+}
+
+/*Splits the operand field at commas outside quotes, trimming each operand.
+Returns the number of operands*/
+static int split_operands(assembler_t* as, char* s, char* operands[]){
+    int count=0;
+
+    s=(char*)skip_space(s);
+    if(!*s){
+        return 0;
+    }
+
+    for(;;){
+        if(count==MAX_OPERANDS){
+            error(as, "Too many operands", NULL);
+        }
+        operands[count++]=s;
+
+        char quote=0;
+        while(*s && (quote || *s!=',')){
+            if(quote && *s==quote){
+                quote=0;
+            }
+            else if(!quote && (*s=='\'' || *s=='"')){
+                quote=*s;
+            }
+            s++;
+        }
+        if(quote){
+            error(as, "Unterminated string", NULL);
+        }
+
+        char* end=s;
+        while(end>operands[count-1] && (end[-1]==' ' || end[-1]=='\t')){
+            end--;
+        }
+
+        if(!*s){
+            *end='\0';
+            return count;
+        }
+        *end='\0';
+        s=(char*)skip_space(s+1);
+    }
+}
+
+static int is_opcode_mnemonic(const char* name){
+    for(int op=0; op<256; op++){
+        if(!i8080_opcodes[op].undocumented && strcmp(i8080_opcodes[op].mnemonic, name)==0){
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static int is_directive(const char* name){
+    static const char* directives[]={"ORG", "EQU", "DB", "DW", "DS", "END", NULL};
+
+    for(int i=0; directives[i]; i++){
+        if(strcmp(directives[i], name)==0){
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+//Case-insensitive compare of the register operands against one table entry
+static int registers_match(const char* table, char* operands[], int num_registers){
+    for(int i=0; i<num_registers; i++){
+        const char* op=operands[i];
+
+        while(*table && *table!=','){
+            if(toupper((unsigned char)*op)!=*table){
+                return 0;
+            }
+            op++;
+            table++;
+        }
+        if(*op){
+            return 0;
+        }
+        if(*table==','){
+            table++;
+        }
+    }
+
+    return 1;
+}
+
+static void assemble_instruction(assembler_t* as, const char* mnemonic, char* operands[], int count){
+    char rst[2];
+
+    //RST takes its vector number as an expression, the table spells it out as a digit
+    if(strcmp(mnemonic, "RST")==0 && count==1){
+        int n=eval(as, operands[0], 1);
+        if(n<0 || n>7){
+            error(as, "RST vector must be 0-7", NULL);
+        }
+        rst[0]='0'+n;
+        rst[1]='\0';
+        operands[0]=rst;
+    }
+
+    for(int op=0; op<256; op++){
+        const i8080_opcode_t* info=&i8080_opcodes[op];
+
+        if(info->undocumented || strcmp(info->mnemonic, mnemonic)!=0){
+            continue;
+        }
+
+        int num_registers=0;
+        if(info->operands[0]){
+            num_registers=1;
+            for(const char* c=info->operands; *c; c++){
+                num_registers+=*c==',';
+            }
+        }
+
+        int has_immediate=info->kind!=OPERAND_NONE;
+        if(num_registers+has_immediate!=count || !registers_match(info->operands, operands, num_registers)){
+            continue;
+        }
+
+        emit(as, op);
+        if(has_immediate){
+            int value=eval(as, operands[num_registers], 0);
+            emit_value(as, value, info->length-1);
+        }
+        return;
+    }
+
+    error(as, "Invalid operands for", mnemonic);
+}
+
+static void assemble_data(assembler_t* as, const char* directive, char* operands[], int count){
+    if(count==0){
+        error(as, "Missing operand for", directive);
+    }
+
+    for(int i=0; i<count; i++){
+        const char* op=operands[i];
+        size_t len=strlen(op);
+
+        //Strings longer than one character are only allowed in DB, 'c' is a value
+        if(directive[1]=='B' && len>=2 && (op[0]=='\'' || op[0]=='"') && op[len-1]==op[0] && len!=3){
+            for(size_t c=1; c<len-1; c++){
+                emit(as, op[c]);
+            }
+            continue;
+        }
+
+        emit_value(as, eval(as, op, 0), directive[1]=='B' ? 1 : 2);
+    }
+}
+
+//Assembles one line, returns 0 once END is reached
+static int assemble_line(assembler_t* as, char* line){
+    char label[MAX_SYMBOL_LEN+1]="";
+    char mnemonic[MAX_SYMBOL_LEN+1]="";
+    char* operands[MAX_OPERANDS];
+    char* s=line;
+
+    //Strip the comment
+    char quote=0;
+    for(char* c=line; *c; c++){
+        if(quote && *c==quote){
+            quote=0;
+        }
+        else if(!quote && (*c=='\'' || *c=='"')){
+            quote=*c;
+        }
+        else if(!quote && *c==';'){
+            *c='\0';
+            break;
+        }
+    }
+    line[strcspn(line, "\r\n")]='\0';
+
+    //A label either ends in a colon or starts in the first column
+    int first_column=is_ident_start(*s);
+    s=(char*)skip_space(s);
+    if(!*s){
+        return 1;
+    }
+    if(!is_ident_start(*s)){
+        error(as, "Expected a label or mnemonic", s);
+    }
+
+    char word[MAX_SYMBOL_LEN+1];
+    char* after=(char*)read_ident(s, word);
+
+    if(*after==':'){
+        strcpy(label, word);
+        s=(char*)skip_space(after+1);
+    }
+    else{
+        char upper[MAX_SYMBOL_LEN+1];
+        for(int i=0; ; i++){
+            upper[i]=toupper((unsigned char)word[i]);
+            if(!word[i]){
+                break;
+            }
+        }
+
+        if(first_column && !is_opcode_mnemonic(upper) && !is_directive(upper)){
+            strcpy(label, word);
+            s=(char*)skip_space(after);
+        }
+    }
+
+    if(*s){
+        if(!is_ident_start(*s)){
+            error(as, "Expected a mnemonic", s);
+        }
+        s=(char*)read_ident(s, mnemonic);
+        for(char* c=mnemonic; *c; c++){
+            *c=toupper((unsigned char)*c);
+        }
+    }
+
+    int count=split_operands(as, s, operands);
+
+    if(strcmp(mnemonic, "EQU")==0){
+        if(!label[0] || count!=1){
+            error(as, "EQU needs a name and one value", NULL);
+        }
+        define_symbol(as, label, eval(as, operands[0], 1));
+        return 1;
+    }
+
+    if(label[0]){
+        define_symbol(as, label, as->pc);
+    }
+
+    if(!mnemonic[0]){
+        return 1;
+    }
+    else if(strcmp(mnemonic, "ORG")==0){
+        if(count!=1){
+            error(as, "ORG needs one value", NULL);
+        }
+        as->pc=eval(as, operands[0], 1);
+        if(as->pc<0 || as->pc>=MEM_SIZE){
+            error(as, "ORG outside $0000-$ffff", NULL);
+        }
+    }
+    else if(strcmp(mnemonic, "DB")==0 || strcmp(mnemonic, "DW")==0){
+        assemble_data(as, mnemonic, operands, count);
+    }
+    else if(strcmp(mnemonic, "DS")==0){
+        if(count!=1){
+            error(as, "DS needs one value", NULL);
+        }
+        int size=eval(as, operands[0], 1);
+        if(size<0 || as->pc+size>MEM_SIZE){
+            error(as, "Bad DS size", NULL);
+        }
+        as->pc+=size;
+    }
+    else if(strcmp(mnemonic, "END")==0){
+        return 0;
+    }
+    else if(is_opcode_mnemonic(mnemonic)){
+        assemble_instruction(as, mnemonic, operands, count);
+    }
+    else{
+        error(as, "Unknown mnemonic", mnemonic);
+    }
+
+    return 1;
+}
+
+static void assemble_pass(assembler_t* as, FILE* fp, int pass){
+    char line[MAX_LINE];
+
+    rewind(fp);
+    as->pass=pass;
+    as->pc=0;
+    as->line=0;
+
+    while(fgets(line, sizeof(line), fp)){
+        as->line++;
+        if(!assemble_line(as, line)){
+            break;
+        }
+    }
+}
+
+static void write_c_array(FILE* out, const assembler_t* as, const char* name){
+    fprintf(out, "//Generated by asm8080 from %s\n\n", as->file);
+    fprintf(out, "#define %s_ORIGIN 0x%04x\n\n", name, as->low);
+    fprintf(out, "static const uint8_t %s[%d]={", name, as->high-as->low);
+
+    for(int i=0; i<as->high-as->low; i++){
+        fprintf(out, "%s0x%02x", i % 12 ? ", " : (i ? ",\n    " : "\n    "), as->memory[as->low+i]);
+    }
+    fprintf(out, "\n};\n");
+}
+
+int main(int argc, char* argv[]){
+    static assembler_t as;
+    const char* output=NULL;
+    const char* array_name=NULL;
+
+    for(int i=1; i<argc; i++){
+        if(strcmp(argv[i], "-o")==0 && i+1<argc){
+            output=argv[++i];
+        }
+        else if(strcmp(argv[i], "-c")==0 && i+1<argc){
+            array_name=argv[++i];
+        }
+        else if(argv[i][0]!='-' && !as.file){
+            as.file=argv[i];
+        }
+        else{
+            as.file=NULL;
+            break;
+        }
+    }
+
+    if(!as.file){
+        fprintf(stderr, "Usage: %s [-o output] [-c name] file.asm\n", argv[0]);
+        return 1;
+    }
+
+    FILE* fp=fopen(as.file, "r");
+    if(!fp){
+        fprintf(stderr, "Cannot open %s\n", as.file);
+        return 1;
+    }
+
+    as.low=MEM_SIZE;
+    as.high=0;
+    assemble_pass(&as, fp, 1);
+    assemble_pass(&as, fp, 2);
+    fclose(fp);
+
+    if(as.high==0){
+        as.low=0;
+    }
+
+    FILE* out=output ? fopen(output, array_name ? "w" : "wb") : stdout;
+    if(!out){
+        fprintf(stderr, "Cannot create %s\n", output);
+        return 1;
+    }
+
+    if(array_name){
+        write_c_array(out, &as, array_name);
+    }
+    else{
+        fwrite(&as.memory[as.low], 1, as.high-as.low, out);
+    }
+
+    if(out!=stdout){
+        fclose(out);
+    }
+
+    fprintf(stderr, "%s: %d bytes at $%04x-$%04x, %d symbols\n", as.file, as.high-as.low, as.low,
+            as.high ? as.high-1 : 0, as.num_symbols);
+
+    return 0;
+}
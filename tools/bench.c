@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "replay.h"
+#include "rom.h"
+#include "profiler.h"
+
+/*Headless emulation benchmark: replays a recorded input session (such as
+bench/gameplay.rpl, recorded with --record-input) from power-on and reports the
+speed of the fastest run. The CRC of the final machine state shows whether
+differently built binaries emulated the session identically.
+
+Usage: bench [-r runs] [-q] [-d rom_dir] [-p prefix] replay
+  -r runs        timed runs, the fastest is reported (default 5)
+  -q             only print frames per second and the state CRC
+  -p prefix      profile the guest over one extra, untimed run and write
+                 prefix.folded and prefix.txt*/
+
+int main(int argc, char* argv[]){
+    int runs=5;
+    int quiet=0;
+    char* rom_dir=NULL;
+    char* profile_prefix=NULL;
+    char* path=NULL;
+
+    for(int i=1; i<argc; i++){
+        if(strcmp(argv[i], "-r")==0 && i+1<argc){
+            runs=atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-q")==0){
+            quiet=1;
+        }
+        else if(strcmp(argv[i], "-d")==0 && i+1<argc){
+            rom_dir=argv[++i];
+        }
+        else if(strcmp(argv[i], "-p")==0 && i+1<argc){
+            profile_prefix=argv[++i];
+        }
+        else if(argv[i][0]!='-' && !path){
+            path=argv[i];
+        }
+        else{
+            path=NULL;
+            break;
+        }
+    }
+
+    if(!path || runs<1){
+        printf("Usage: %s [-r runs] [-q] [-d rom_dir] [-p prefix] replay\n", argv[0]);
+        return 1;
+    }
+
+    char rom_path[ROM_PATH_MAX]="";
+
+#ifndef EMBED_ROMS
+    if(rom_find_dir(rom_dir, rom_path, sizeof(rom_path))<0){
+        printf("Cannot find the ROM directory\n");
+        return 1;
+    }
+#else
+    (void)rom_dir;
+#endif
+
+    replay_t* replay=replay_load(path);
+    if(!replay){
+        return 1;
+    }
+
+    int frames=replay->num_samples / 2;
+    uint64_t best_us=UINT64_MAX;
+    uint64_t cycles=0;
+    uint32_t crc=0;
+
+    for(int run=0; run<runs; run++){
+        machine_t* machine=init_machine();
+
+        if(load_game(machine, rom_path)<0){
+            return 1;
+        }
+
+        uint64_t start=latency_now_us();
+
+        for(int f=0; f<frames; f++){
+            replay_run_frame(machine, &replay->samples[2*f]);
+        }
+
+        uint64_t elapsed=latency_now_us()-start;
+        if(elapsed<best_us){
+            best_us=elapsed;
+        }
+
+        uint8_t state[MACHINE_STATE_SIZE];
+        machine_save_state(machine, state);
+        crc=rom_crc32(state, sizeof(state));
+        cycles=machine->counters.cycles;
+
+        destroy_machine(machine);
+    }
+
+    //Profiling slows emulation down, so it gets a run of its own
+    if(profile_prefix){
+        machine_t* machine=init_machine();
+
+        if(load_game(machine, rom_path)<0){
+            return 1;
+        }
+
+        machine->profiler=profiler_init();
+
+        for(int f=0; f<frames; f++){
+            replay_run_frame(machine, &replay->samples[2*f]);
+        }
+
+        if(profiler_save(machine->profiler, profile_prefix, machine->machine_mem, MACHINE_MEM_SIZE)<0){
+            return 1;
+        }
+
+        profiler_destroy(machine->profiler);
+        destroy_machine(machine);
+    }
+
+    double seconds=best_us / 1e6;
+
+    if(quiet){
+        printf("%.0f %08x\n", frames / seconds, crc);
+    }
+    else{
+        printf("%d frames in %.1f ms (best of %d): %.0f frames/s, %.1f emulated MHz (%.1fx real time)\n",
+               frames, best_us / 1000.0, runs, frames / seconds, cycles / seconds / 1e6,
+               frames / seconds / FPS);
+        printf("Final state CRC %08x\n", crc);
+    }
+
+    replay_close(replay);
+
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cpm_machine.h"
+
+/*Runs a CP/M .COM program (e.g. the 8080 exercisers TST8080.COM, 8080PRE.COM,
+8080EXM.COM) at full speed and reports the host time and emulated clock rate.
+
+Usage: cpm [-c max_cycles] program.com*/
+
+int main(int argc, char* argv[]){
+    uint64_t max_cycles=0;
+    char* path=NULL;
+
+    for(int i=1; i<argc; i++){
+        if(strcmp(argv[i], "-c")==0 && i+1<argc){
+            max_cycles=strtoull(argv[++i], NULL, 0);
+        }
+        else if(argv[i][0]!='-' && !path){
+            path=argv[i];
+        }
+        else{
+            path=NULL;
+            break;
+        }
+    }
+
+    if(!path){
+        fprintf(stderr, "Usage: %s [-c max_cycles] program.com\n", argv[0]);
+        return 1;
+    }
+
+    cpm_machine_t* cpm=cpm_init(stdout);
+
+    if(cpm_load_com(cpm, path)<0){
+        cpm_destroy(cpm);
+        return 1;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    cpm_run(cpm, max_cycles);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds=(end.tv_sec-start.tv_sec)+(end.tv_nsec-start.tv_nsec) / 1e9;
+
+    fprintf(stderr, "\n%s after %llu instructions, %llu cycles in %.3f s: %.1f MHz emulated (%.1fx a 2 MHz 8080)\n",
+            cpm->finished ? "Finished" : "Stopped", (unsigned long long)cpm->instructions,
+            (unsigned long long)cpm->cycles, seconds, cpm->cycles / seconds / 1e6, cpm->cycles / seconds / 2e6);
+
+    int status=cpm->finished ? 0 : 2;
+    cpm_destroy(cpm);
+
+    return status;
+}
@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "disassembler.h"
+
+#define MAX_ROM_SIZE		0x10000
+#define MAX_ENTRIES		64
+
+/*Whole-ROM disassembler. The files are concatenated at the origin address, code is
+found by following control flow from the entry points and the labelled listing is
+written to stdout.
+
+Usage: disasm [-o origin] [-e entry]... file...
+Without -e, the reset vector and the RST 1/RST 2 interrupt vectors are used*/
+
+static void usage(const char* name){
+    fprintf(stderr, "Usage: %s [-o origin] [-e entry]... file...\n", name);
+    exit(1);
+}
+
+static double elapsed_ms(struct timespec* start){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec-start->tv_sec) * 1000.0 + (now.tv_nsec-start->tv_nsec) / 1000000.0;
+}
+
+int main(int argc, char* argv[]){
+    static uint8_t rom[MAX_ROM_SIZE];
+    static uint8_t map[MAX_ROM_SIZE];
+    uint16_t entries[MAX_ENTRIES];
+    int num_entries=0;
+    uint16_t origin=0;
+    int size=0;
+
+    for(int i=1; i<argc; i++){
+        if(strcmp(argv[i], "-o")==0 && i+1<argc){
+            origin=strtol(argv[++i], NULL, 0);
+        }
+        else if(strcmp(argv[i], "-e")==0 && i+1<argc){
+            if(num_entries==MAX_ENTRIES){
+                fprintf(stderr, "Too many entry points\n");
+                return 1;
+            }
+            entries[num_entries++]=strtol(argv[++i], NULL, 0);
+        }
+        else if(argv[i][0]=='-'){
+            usage(argv[0]);
+        }
+        else{
+            FILE* fp=fopen(argv[i], "rb");
+            if(!fp){
+                fprintf(stderr, "Cannot open %s\n", argv[i]);
+                return 1;
+            }
+
+            size+=fread(&rom[size], 1, MAX_ROM_SIZE-origin-size, fp);
+            fclose(fp);
+        }
+    }
+
+    if(size==0){
+        usage(argv[0]);
+    }
+
+    if(num_entries==0){
+        entries[num_entries++]=origin;
+
+        //The interrupt vectors are absolute, so they only count when the image covers them
+        for(int vector=0x08; vector<=0x10; vector+=0x08){
+            if(vector>=origin && vector<origin+size){
+                entries[num_entries++]=vector;
+            }
+        }
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    i8080_discover_code(rom, size, origin, entries, num_entries, map);
+    double discover_ms=elapsed_ms(&start);
+
+    i8080_write_listing(stdout, rom, size, origin, map);
+
+    int code_bytes=0;
+    for(int i=0; i<size; i++){
+        code_bytes+=(map[i] & (DISASM_CODE | DISASM_OPERAND))!=0;
+    }
+
+    fprintf(stderr, "%d of %d bytes are code, discovery took %.3f ms, total %.3f ms\n",
+            code_bytes, size, discover_ms, elapsed_ms(&start));
+
+    return 0;
+}
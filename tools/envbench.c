@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "env.h"
+
+/*Throughput benchmark and example client for the environment API in src/env.h. Plays
+random actions in a batch of environments and reports env-steps per second and the
+episodes finished.
+
+Usage: envbench [-n envs] [-j threads] [-s steps] [-k frame_skip] [-p sticky] [-l] [-v] [rom_dir]
+  -n envs        environments stepped together (default 16)
+  -j threads     worker threads, 0 = one per CPU (default 1)
+  -s steps       batches to run (default 2000)
+  -k frame_skip  emulated frames per step (default 4)
+  -p sticky      sticky action probability (default 0.25)
+  -l             end episodes when a ship is lost, with a reward of -100
+  -v             raw VRAM observations instead of downsampled ones*/
+
+static double now_seconds(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char* argv[]){
+    env_config_t config;
+    env_default_config(&config);
+    config.num_threads=1;
+
+    int num_envs=16;
+    long steps=2000;
+
+    for(int i=1; i<argc; i++){
+        if(strcmp(argv[i], "-n")==0 && i+1<argc){
+            num_envs=atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-j")==0 && i+1<argc){
+            config.num_threads=atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-s")==0 && i+1<argc){
+            steps=atol(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-k")==0 && i+1<argc){
+            config.frame_skip=atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-p")==0 && i+1<argc){
+            config.sticky_actions=atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-l")==0){
+            config.done_on_life_loss=1;
+            config.life_loss_reward=-100;
+        }
+        else if(strcmp(argv[i], "-v")==0){
+            config.obs_type=ENV_OBS_VRAM;
+        }
+        else if(argv[i][0]!='-'){
+            config.rom_dir=argv[i];
+        }
+        else{
+            printf("Usage: %s [-n envs] [-j threads] [-s steps] [-k frame_skip] [-p sticky] [-l] [-v] [rom_dir]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if(num_envs<1){
+        printf("Need at least one environment\n");
+        return 1;
+    }
+
+    env_t* env=env_create(num_envs, &config);
+    if(!env){
+        return 1;
+    }
+
+    uint8_t* obs=malloc((size_t)num_envs * env->obs_size);
+    float* rewards=malloc(sizeof(float) * num_envs);
+    uint8_t* dones=malloc(num_envs);
+    int* actions=malloc(sizeof(int) * num_envs);
+    double* returns=calloc(num_envs, sizeof(double));
+
+    uint64_t episodes=0;
+    double total_return=0;
+    unsigned int seed=1;
+
+    env_reset(env, obs);
+
+    double start=now_seconds();
+
+    for(long step=0; step<steps; step++){
+        for(int i=0; i<num_envs; i++){
+            actions[i]=rand_r(&seed) % ENV_NUM_ACTIONS;
+        }
+
+        env_step(env, actions, obs, rewards, dones);
+
+        for(int i=0; i<num_envs; i++){
+            returns[i]+=rewards[i];
+
+            if(dones[i]){
+                total_return+=returns[i];
+                returns[i]=0;
+                episodes++;
+            }
+        }
+    }
+
+    double elapsed=now_seconds()-start;
+    double env_steps=(double)steps * num_envs;
+
+    printf("%d envs, %d threads, frame skip %d: %.0f env-steps/s (%.0f frames/s) in %.2f s\n",
+           num_envs, env->num_threads, env->config.frame_skip, env_steps / elapsed,
+           env_steps * env->config.frame_skip / elapsed, elapsed);
+    printf("%llu episodes finished, mean score %.1f\n", (unsigned long long)episodes,
+           episodes ? total_return / episodes : 0.0);
+
+    env_destroy(env);
+    free(obs);
+    free(rewards);
+    free(dones);
+    free(actions);
+    free(returns);
+
+    return 0;
+}
@@ -0,0 +1,441 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+
+#include "i8080_cpu.h"
+#include "i8080_reference.h"
+#include "i8080_opcodes.h"
+#include "disassembler.h"
+
+#define MEM_SIZE		0x10000
+#define DEFAULT_STEPS		64
+#define REPORT_INTERVAL		10		//Seconds between soak progress lines
+
+/*Differential fuzzer. Each case seeds a random register, flag and memory state,
+writes a random instruction sequence at PC, and runs it on the reference engine
+and a candidate engine side by side, comparing the full CPU state and every byte
+an instruction could have stored after each step (all 64K at the end of a case). A mismatch is shrunk to a single instruction from
+a minimal state before it is reported.
+
+Usage: fuzz8080 [-r engine] [-e engine] [-n cases] [-l steps] [-t seconds] [-s seed] [-k] [-x case]
+    -r/-e   reference and candidate engine (see -h for the list)
+    -n      number of cases (default: run until -t expires or a mismatch is found)
+    -l      instructions per case (default 64)
+    -t      soak for this many seconds, printing progress every 10 s
+    -s      base seed, every case seed is derived from it so runs are repeatable
+    -k      keep going after a mismatch
+    -x      replay one case seed, as printed in a report*/
+
+typedef struct{
+    const char* name;
+    const char* description;
+    void (*step)(i8080* cpu);
+} engine_t;
+
+//Engines that can be compared. New execution engines are added here
+static const engine_t engines[]={
+    {"reference", "frozen copy of the original switch interpreter", i8080_reference_emulator},
+    {"switch", "i8080_emulator(), generated from the opcode table", i8080_emulator},
+};
+
+#define NUM_ENGINES		(int)(sizeof(engines) / sizeof(engines[0]))
+
+typedef struct{
+    i8080 cpu;
+    uint8_t memory[MEM_SIZE];
+} fuzz_state_t;
+
+static volatile sig_atomic_t interrupted=0;
+
+static void on_signal(int sig){
+    (void)sig;
+    interrupted=1;
+}
+
+//splitmix64, used both to derive case seeds and as the case generator
+static inline uint64_t next_random(uint64_t* state){
+    uint64_t z=(*state+=0x9E3779B97F4A7C15ULL);
+
+    z=(z ^ (z>>30)) * 0xBF58476D1CE4E5B9ULL;
+    z=(z ^ (z>>27)) * 0x94D049BB133111EBULL;
+
+    return z ^ (z>>31);
+}
+
+static const engine_t* find_engine(const char* name){
+    for(int i=0; i<NUM_ENGINES; i++){
+        if(strcmp(engines[i].name, name)==0){
+            return &engines[i];
+        }
+    }
+
+    fprintf(stderr, "Unknown engine %s\n", name);
+    exit(2);
+}
+
+//Builds the starting state of a case from its seed
+static void generate_case(fuzz_state_t* state, uint64_t seed, int steps){
+    uint64_t rng=seed;
+
+    for(int i=0; i<MEM_SIZE; i+=8){
+        uint64_t r=next_random(&rng);
+        memcpy(&state->memory[i], &r, 8);
+    }
+
+    uint64_t r=next_random(&rng);
+    i8080* cpu=&state->cpu;
+
+    memset(cpu, 0, sizeof(i8080));
+    cpu->A=r;
+    cpu->B=r>>8;
+    cpu->C=r>>16;
+    cpu->D=r>>24;
+    cpu->E=r>>32;
+    cpu->H=r>>40;
+    cpu->L=r>>48;
+    i8080_set_psw(cpu, r>>56);
+
+    cpu->address_mask=0xFFFF;
+
+    r=next_random(&rng);
+    cpu->SP=r;
+    cpu->PC=r>>16;
+    cpu->interrupt_enable=(r>>32) & 1;
+
+    //Lay the sequence out on instruction boundaries so the straight-line part of
+    //it decodes as intended; operand bytes keep their random values
+    uint16_t pc=cpu->PC;
+    for(int i=0; i<steps; i++){
+        uint8_t opcode=next_random(&rng);
+        state->memory[pc]=opcode;
+        pc+=i8080_opcodes[opcode].length;
+    }
+}
+
+static void run_step(const engine_t* engine, fuzz_state_t* state){
+    state->cpu.memory=state->memory;
+    engine->step(&state->cpu);
+}
+
+static const char* diff_names[]={"A", "B", "C", "D", "E", "H", "L", "SP", "PC", "PSW", "IE", "cycles", "memory"};
+
+#define DIFF_MEMORY		(1<<12)
+
+//Compares the CPU registers, returning a bitmask with bit n set if field n of diff_names differs
+static int compare_registers(const fuzz_state_t* a, const fuzz_state_t* b){
+    const i8080* x=&a->cpu;
+    const i8080* y=&b->cpu;
+    int diff=0;
+
+    diff|=(x->A!=y->A)<<0;
+    diff|=(x->B!=y->B)<<1;
+    diff|=(x->C!=y->C)<<2;
+    diff|=(x->D!=y->D)<<3;
+    diff|=(x->E!=y->E)<<4;
+    diff|=(x->H!=y->H)<<5;
+    diff|=(x->L!=y->L)<<6;
+    diff|=(x->SP!=y->SP)<<7;
+    diff|=(x->PC!=y->PC)<<8;
+    diff|=(i8080_get_psw((i8080*)x)!=i8080_get_psw((i8080*)y))<<9;
+    diff|=(x->interrupt_enable!=y->interrupt_enable)<<10;
+    diff|=(x->instruction_cycles!=y->instruction_cycles)<<11;
+
+    return diff;
+}
+
+static int compare_states(const fuzz_state_t* a, const fuzz_state_t* b){
+    return compare_registers(a, b)|(memcmp(a->memory, b->memory, MEM_SIZE)!=0 ? DIFF_MEMORY : 0);
+}
+
+/*Every 8080 store goes through HL, BC, DE, the stack or a direct address, so
+comparing those bytes after each step and all of memory at the end of the case
+finds a mismatch without a 64K compare per instruction*/
+static void store_targets(const fuzz_state_t* state, uint16_t targets[6]){
+    const i8080* cpu=&state->cpu;
+    uint16_t pc=cpu->PC;
+
+    targets[0]=(cpu->H<<8)|cpu->L;
+    targets[1]=(cpu->B<<8)|cpu->C;
+    targets[2]=(cpu->D<<8)|cpu->E;
+    targets[3]=cpu->SP-2;
+    targets[4]=cpu->SP;
+    targets[5]=(state->memory[(uint16_t)(pc+2)]<<8)|state->memory[(uint16_t)(pc+1)];
+}
+
+static int compare_targets(const fuzz_state_t* a, const fuzz_state_t* b, const uint16_t targets[6]){
+    for(int i=0; i<6; i++){
+        if(a->memory[targets[i]]!=b->memory[targets[i]] ||
+           a->memory[(uint16_t)(targets[i]+1)]!=b->memory[(uint16_t)(targets[i]+1)]){
+            return DIFF_MEMORY;
+        }
+    }
+
+    return 0;
+}
+
+/*Runs up to steps instructions from start on both engines. Returns the index of
+the first instruction after which the states differ, or -1*/
+static int run_case_checked(const engine_t* ref, const engine_t* cand, const fuzz_state_t* start,
+                            fuzz_state_t* a, fuzz_state_t* b, int steps, int full_compare){
+    uint16_t targets[6];
+
+    memcpy(a, start, sizeof(fuzz_state_t));
+    memcpy(b, start, sizeof(fuzz_state_t));
+
+    for(int i=0; i<steps; i++){
+        store_targets(a, targets);
+        run_step(ref, a);
+        run_step(cand, b);
+
+        int diff=full_compare ? compare_states(a, b) : compare_registers(a, b)|compare_targets(a, b, targets);
+        if(diff){
+            return i;
+        }
+    }
+
+    if(!full_compare && memcmp(a->memory, b->memory, MEM_SIZE)!=0){
+        //A store went somewhere unexpected, find the instruction that did it
+        return run_case_checked(ref, cand, start, a, b, steps, 1);
+    }
+
+    return -1;
+}
+
+static int run_case(const engine_t* ref, const engine_t* cand, const fuzz_state_t* start,
+                    fuzz_state_t* a, fuzz_state_t* b, int steps){
+    return run_case_checked(ref, cand, start, a, b, steps, 0);
+}
+
+/*Reduces a failing case to one instruction: the reference state just before the
+first mismatch becomes the new start. Then registers and memory are cleared
+wherever the mismatch survives it, memory in halving blocks*/
+static void shrink_case(const engine_t* ref, const engine_t* cand, fuzz_state_t* start, int fail_step,
+                        fuzz_state_t* a, fuzz_state_t* b){
+    for(int i=0; i<fail_step; i++){
+        run_step(ref, start);
+    }
+    start->cpu.instruction_cycles=0;
+
+    //The instruction bytes themselves have to stay
+    uint16_t pc=start->cpu.PC;
+    uint8_t instruction[3];
+    int length=i8080_opcodes[start->memory[pc]].length;
+    for(int i=0; i<3; i++){
+        instruction[i]=start->memory[(uint16_t)(pc+i)];
+    }
+
+    static fuzz_state_t trial;
+
+    uint8_t* regs[]={&start->cpu.A, &start->cpu.B, &start->cpu.C, &start->cpu.D,
+                     &start->cpu.E, &start->cpu.H, &start->cpu.L};
+    for(int i=0; i<7; i++){
+        uint8_t saved=*regs[i];
+        *regs[i]=0;
+        if(run_case(ref, cand, start, a, b, 1)<0){
+            *regs[i]=saved;
+        }
+    }
+
+    uint8_t psw=i8080_get_psw(&start->cpu);
+    i8080_set_psw(&start->cpu, 0);
+    if(run_case(ref, cand, start, a, b, 1)<0){
+        i8080_set_psw(&start->cpu, psw);
+    }
+
+    uint16_t sp=start->cpu.SP;
+    start->cpu.SP=0;
+    if(run_case(ref, cand, start, a, b, 1)<0){
+        start->cpu.SP=sp;
+    }
+
+    for(int block=MEM_SIZE; block>=1; block/=2){
+        for(int addr=0; addr<MEM_SIZE; addr+=block){
+            memcpy(&trial, start, sizeof(fuzz_state_t));
+            memset(&trial.memory[addr], 0, block);
+            for(int i=0; i<length; i++){
+                trial.memory[(uint16_t)(pc+i)]=instruction[i];
+            }
+
+            if(memcmp(trial.memory, start->memory, MEM_SIZE)!=0 && run_case(ref, cand, &trial, a, b, 1)>=0){
+                memcpy(start, &trial, sizeof(fuzz_state_t));
+            }
+        }
+    }
+}
+
+static void print_state(const char* name, const fuzz_state_t* state){
+    const i8080* cpu=&state->cpu;
+
+    printf("  %-8s A=%02x B=%02x C=%02x D=%02x E=%02x H=%02x L=%02x SP=%04x PC=%04x PSW=%02x IE=%d cycles=%d\n",
+           name, cpu->A, cpu->B, cpu->C, cpu->D, cpu->E, cpu->H, cpu->L, cpu->SP, cpu->PC,
+           i8080_get_psw((i8080*)cpu), cpu->interrupt_enable, cpu->instruction_cycles);
+}
+
+static void report_failure(const engine_t* ref, const engine_t* cand, uint64_t case_seed,
+                           int steps, int fail_step){
+    static fuzz_state_t start, a, b;
+    char text[32];
+
+    generate_case(&start, case_seed, steps);
+    shrink_case(ref, cand, &start, fail_step, &a, &b);
+    run_case(ref, cand, &start, &a, &b, 1);
+
+    i8080_disasm(text, sizeof(text), start.memory, MEM_SIZE, start.cpu.PC);
+    printf("MISMATCH in case %016llx at instruction %d: %s (%02x)\n",
+           (unsigned long long)case_seed, fail_step, text, start.memory[start.cpu.PC]);
+
+    printf("  differs:");
+    int diff=compare_states(&a, &b);
+    for(int i=0; i<(int)(sizeof(diff_names) / sizeof(diff_names[0])); i++){
+        if(diff & (1<<i)){
+            printf(" %s", diff_names[i]);
+        }
+    }
+    printf("\n");
+
+    print_state("before", &start);
+    print_state(ref->name, &a);
+    print_state(cand->name, &b);
+
+    printf("  memory before (non-zero):");
+    for(int addr=0; addr<MEM_SIZE; addr++){
+        if(start.memory[addr]){
+            printf(" %04x=%02x", addr, start.memory[addr]);
+        }
+    }
+    printf("\n");
+
+    for(int addr=0; addr<MEM_SIZE; addr++){
+        if(a.memory[addr]!=b.memory[addr]){
+            printf("  memory %04x: %s=%02x %s=%02x\n", addr, ref->name, a.memory[addr], cand->name, b.memory[addr]);
+        }
+    }
+    fflush(stdout);
+}
+
+static void usage(const char* name){
+    fprintf(stderr, "Usage: %s [-r engine] [-e engine] [-n cases] [-l steps] [-t seconds] [-s seed] [-k] [-x case]\n", name);
+    fprintf(stderr, "Engines:\n");
+    for(int i=0; i<NUM_ENGINES; i++){
+        fprintf(stderr, "  %-10s %s\n", engines[i].name, engines[i].description);
+    }
+    exit(2);
+}
+
+static double elapsed_seconds(const struct timespec* start){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec-start->tv_sec)+(now.tv_nsec-start->tv_nsec) / 1e9;
+}
+
+int main(int argc, char* argv[]){
+    const engine_t* ref=&engines[0];
+    const engine_t* cand=&engines[NUM_ENGINES-1];
+    uint64_t num_cases=0;
+    uint64_t seed=time(NULL);
+    uint64_t replay=0;
+    int replaying=0;
+    int steps=DEFAULT_STEPS;
+    double seconds=0;
+    int keep_going=0;
+
+    for(int i=1; i<argc; i++){
+        if(strcmp(argv[i], "-r")==0 && i+1<argc){
+            ref=find_engine(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-e")==0 && i+1<argc){
+            cand=find_engine(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-n")==0 && i+1<argc){
+            num_cases=strtoull(argv[++i], NULL, 0);
+        }
+        else if(strcmp(argv[i], "-l")==0 && i+1<argc){
+            steps=atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-t")==0 && i+1<argc){
+            seconds=atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-s")==0 && i+1<argc){
+            seed=strtoull(argv[++i], NULL, 0);
+        }
+        else if(strcmp(argv[i], "-x")==0 && i+1<argc){
+            replay=strtoull(argv[++i], NULL, 16);
+            replaying=1;
+        }
+        else if(strcmp(argv[i], "-k")==0){
+            keep_going=1;
+        }
+        else{
+            usage(argv[0]);
+        }
+    }
+
+    if(steps<1){
+        usage(argv[0]);
+    }
+
+    static fuzz_state_t start, a, b;
+
+    if(replaying){
+        generate_case(&start, replay, steps);
+        int fail_step=run_case(ref, cand, &start, &a, &b, steps);
+        if(fail_step<0){
+            printf("Case %016llx matches\n", (unsigned long long)replay);
+            return 0;
+        }
+        report_failure(ref, cand, replay, steps, fail_step);
+        return 1;
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    printf("Comparing %s against %s, seed %llu, %d instructions per case\n",
+           cand->name, ref->name, (unsigned long long)seed, steps);
+
+    struct timespec start_time;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    double next_report=REPORT_INTERVAL;
+    uint64_t failures=0;
+    uint64_t cases=0;
+    uint64_t seed_state=seed;
+
+    while(!interrupted && (num_cases==0 || cases<num_cases)){
+        uint64_t case_seed=next_random(&seed_state);
+
+        generate_case(&start, case_seed, steps);
+        int fail_step=run_case(ref, cand, &start, &a, &b, steps);
+        cases++;
+
+        if(fail_step>=0){
+            failures++;
+            report_failure(ref, cand, case_seed, steps, fail_step);
+            if(!keep_going){
+                break;
+            }
+        }
+
+        //Checking the clock every case would show up in the profile
+        if((cases & 0xFF)==0 && (seconds>0 || num_cases==0)){
+            double elapsed=elapsed_seconds(&start_time);
+            if(seconds>0 && elapsed>=seconds){
+                break;
+            }
+            if(elapsed>=next_report){
+                printf("%.0f s: %llu cases, %.0f cases/s, %llu mismatches\n", elapsed,
+                       (unsigned long long)cases, cases / elapsed, (unsigned long long)failures);
+                fflush(stdout);
+                next_report+=REPORT_INTERVAL;
+            }
+        }
+    }
+
+    double elapsed=elapsed_seconds(&start_time);
+    printf("%llu cases (%llu instructions) in %.1f s, %llu mismatches\n", (unsigned long long)cases,
+           (unsigned long long)cases * steps, elapsed, (unsigned long long)failures);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,201 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "netplay.h"
+#include "rom.h"
+
+/*Rollback netplay check over localhost: runs both players' machines headless in one
+process, each with its own UDP socket, at 60 frames per second. Player 1 inserts two
+coins and starts a two-player game, then both press random buttons. When every input
+has arrived, both machines and a third one run with all the inputs in order must end
+in the same state.
+
+Usage: netplay [-f frames] [-d delay_ms] [-l loss_percent] [-p port] [rom_dir]
+  -f frames        frames to play (default 600)
+  -d delay_ms      artificial delay of every packet, each way (default 0)
+  -l loss_percent  share of packets dropped (default 0)
+  -p port          UDP port of player 1, player 2 uses the next one (default 4080)*/
+
+#define RANDOM_INPUT_FRAMES		8		//Random buttons are held this long
+#define STALL_TIMEOUT_US		5000000		//Give up when no frame has been run for this long
+
+typedef struct{
+    machine_t* machine;
+    netplay_t* netplay;
+    uint8_t* inputs;		//Buttons each frame ran with
+} peer_t;
+
+//Buttons of player at frame: player 1 starts a two-player game, then both play at random
+static uint8_t script_buttons(int player, uint32_t frame){
+    if(frame<150){
+        if(player==0 && ((frame>=60 && frame<65) || (frame>=90 && frame<95))){
+            return 1<<0;
+        }
+        if(player==0 && frame>=120 && frame<125){
+            return 1<<1;
+        }
+        return 0;
+    }
+
+    //Hashed from the frame, so a stalled frame gets the same buttons when it is retried
+    uint32_t hash=(frame / RANDOM_INPUT_FRAMES) * 2654435761u + player * 40503u;
+    hash^=hash>>15;
+    hash*=2246822519u;
+    hash^=hash>>13;
+
+    return hash & NETPLAY_CONTROLS;
+}
+
+//CRC of the machine state, ignoring the input ports, which differ between the peers
+static uint32_t state_crc(machine_t* machine){
+    uint8_t state[MACHINE_STATE_SIZE];
+
+    machine->port_in1=(1<<3);
+    machine->port_in2=0;
+    machine_save_state(machine, state);
+
+    return rom_crc32(state, sizeof(state));
+}
+
+int main(int argc, char* argv[]){
+    uint32_t frames=600;
+    int delay_ms=0;
+    int loss_percent=0;
+    int port=NETPLAY_DEFAULT_PORT;
+    char* rom_dir=NULL;
+
+    for(int i=1; i<argc; i++){
+        if(strcmp(argv[i], "-f")==0 && i+1<argc){
+            frames=atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-d")==0 && i+1<argc){
+            delay_ms=atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-l")==0 && i+1<argc){
+            loss_percent=atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-p")==0 && i+1<argc){
+            port=atoi(argv[++i]);
+        }
+        else if(argv[i][0]!='-'){
+            rom_dir=argv[i];
+        }
+        else{
+            printf("Usage: %s [-f frames] [-d delay_ms] [-l loss_percent] [-p port] [rom_dir]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if(delay_ms<0 || delay_ms>NETPLAY_MAX_DELAY_MS || loss_percent<0 || loss_percent>=100){
+        printf("Delay must be 0-%d ms and loss 0-99%%\n", NETPLAY_MAX_DELAY_MS);
+        return 1;
+    }
+
+    char rom_path[ROM_PATH_MAX]="";
+
+#ifndef EMBED_ROMS
+    if(rom_find_dir(rom_dir, rom_path, sizeof(rom_path))<0){
+        printf("Cannot find the ROM directory\n");
+        return 1;
+    }
+#else
+    (void)rom_dir;
+#endif
+
+    peer_t peers[2];
+
+    for(int i=0; i<2; i++){
+        char address[32];
+        snprintf(address, sizeof(address), "127.0.0.1:%d", port+1-i);
+
+        peers[i].machine=init_machine();
+        peers[i].inputs=calloc(frames, 1);
+
+        if(load_game(peers[i].machine, rom_path)<0){
+            return 1;
+        }
+
+        peers[i].netplay=netplay_open(i+1, port+i, address);
+        if(!peers[i].netplay){
+            return 1;
+        }
+
+        netplay_simulate(peers[i].netplay, delay_ms, loss_percent);
+    }
+
+    uint64_t next_frame_us=latency_now_us();
+    uint64_t last_progress_us=next_frame_us;
+
+    while(1){
+        int done=1;
+
+        for(int i=0; i<2; i++){
+            netplay_t* netplay=peers[i].netplay;
+            machine_t* machine=peers[i].machine;
+
+            if(netplay->frame<frames){
+                uint32_t frame=netplay->frame;
+                uint8_t buttons=script_buttons(i, frame);
+
+                machine->port_in1=(1<<3) | buttons;
+                if(netplay_frame(netplay, machine)){
+                    peers[i].inputs[frame]=buttons;
+                    last_progress_us=latency_now_us();
+                }
+            }
+            else{
+                netplay_poll(netplay, machine);
+            }
+
+            if(netplay->frame<frames || netplay->remote_next<frames){
+                done=0;
+            }
+        }
+
+        if(done){
+            break;
+        }
+
+        if(latency_now_us()-last_progress_us>STALL_TIMEOUT_US){
+            printf("No progress for %d s, giving up\n", STALL_TIMEOUT_US / 1000000);
+            return 1;
+        }
+
+        next_frame_us+=1000000 / FPS;
+
+        uint64_t now=latency_now_us();
+        if(next_frame_us>now){
+            usleep(next_frame_us-now);
+        }
+    }
+
+    //Both machines must have ended up where running every input in order leads
+    machine_t* reference=init_machine();
+    if(load_game(reference, rom_path)<0){
+        return 1;
+    }
+
+    for(uint32_t f=0; f<frames; f++){
+        netplay_run_frame(reference, peers[0].inputs[f], peers[1].inputs[f]);
+    }
+
+    uint32_t crcs[3]={state_crc(peers[0].machine), state_crc(peers[1].machine), state_crc(reference)};
+
+    for(int i=0; i<2; i++){
+        printf("Player %d:\n", i+1);
+        netplay_print_stats(peers[i].netplay, stdout);
+        netplay_close(peers[i].netplay);
+        destroy_machine(peers[i].machine);
+        free(peers[i].inputs);
+    }
+
+    destroy_machine(reference);
+
+    int in_sync=crcs[0]==crcs[2] && crcs[1]==crcs[2];
+    printf("Final state CRC %08x %08x, expected %08x: %s\n", crcs[0], crcs[1], crcs[2],
+           in_sync ? "in sync" : "DESYNC");
+
+    return in_sync ? 0 : 1;
+}
@@ -0,0 +1,311 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ramsearch.h"
+#include "rom.h"
+
+/*Interactive RAM search for finding game variables (score, lives, positions) in
+0x2000-0x3FFF. Runs headless machines, filters candidate addresses with predicates
+against the previous snapshot or a value, and shows pinned addresses live.
+
+Usage: ramsearch [-n instances] [-l] [rom_dir]
+  -n instances   machines searched together, an address must pass on all (default 1)
+  -l             run at 60 fps so the watch list can be followed live
+
+Commands (numbers are hex):
+  r [frames] [pred [value]]  run frames (default 1), filtering after every frame
+  = | ! | > | < [value]      keep addresses equal / not equal / above / below the
+                             previous snapshot, or value
+  i keys                     hold inputs: c coin, s start, l left, r right, f fire,
+                             - nothing, ? random per instance
+  l [count]                  list candidates with their previous and current values
+  n                          new search, every address is a candidate again
+  w addr [2]                 watch a byte (or a 16-bit word)
+  wd addr                    stop watching
+  q                          quit
+
+Finding the number of ships: start a game with "i c", "r 80", "i s", "r 80", then
+"n" and "r 100 =" while nothing happens, play with "i ?" and "r 400" until a ship is
+lost and narrow down with "<"*/
+
+#define RANDOM_INPUT_FRAMES		8		//Random inputs are held this long
+
+typedef struct{
+    machine_t** machines;
+    int num_instances;
+    ramsearch_t* search;
+
+    uint8_t keys;		//Port 1 bits held for every instance
+    int random_keys;
+    unsigned int* seeds;
+
+    int live;
+    int tty;
+    uint64_t frame;
+} session_t;
+
+static const struct{
+    char name;
+    uint8_t bit;
+} key_bits[]={{'c', 1<<0}, {'s', 1<<2}, {'f', 1<<4}, {'l', 1<<5}, {'r', 1<<6}};
+
+static int parse_predicate(const char* text){
+    switch(text[0]){
+        case '=': return RAMSEARCH_EQUAL;
+        case '!': return RAMSEARCH_NOT_EQUAL;
+        case '>': return RAMSEARCH_GREATER;
+        case '<': return RAMSEARCH_LESS;
+    }
+
+    return -1;
+}
+
+static void print_watches(session_t* session, int in_place){
+    ramsearch_t* search=session->search;
+
+    if(search->num_watches==0){
+        return;
+    }
+
+    printf("%sframe %llu:", in_place ? "\r" : "", (unsigned long long)session->frame);
+
+    for(int w=0; w<search->num_watches; w++){
+        ramsearch_watch_t* watch=&search->watches[w];
+        printf("  %04x=", watch->addr);
+
+        for(int i=0; i<session->num_instances; i++){
+            const uint8_t* mem=session->machines[i]->machine_mem;
+            int value=mem[watch->addr];
+
+            if(watch->size==2){
+                value|=mem[watch->addr+1]<<8;
+            }
+
+            printf(i ? ",%0*x" : "%0*x", watch->size*2, value);
+        }
+    }
+
+    printf(in_place ? "   " : "\n");
+    fflush(stdout);
+}
+
+static void run_frames(session_t* session, long frames, int predicate, int value){
+    uint64_t next_frame_us=latency_now_us();
+    uint64_t last_print_us=0;
+
+    for(long f=0; f<frames; f++){
+        for(int i=0; i<session->num_instances; i++){
+            machine_t* machine=session->machines[i];
+            uint8_t keys=session->keys;
+
+            if(session->random_keys){
+                if(session->frame % RANDOM_INPUT_FRAMES==0){
+                    session->seeds[i]=session->seeds[i]*1103515245 + 12345;
+                }
+
+                //Fire, left and right only, coin and start would restart the game
+                keys=(session->seeds[i]>>16) & 0x70;
+            }
+
+            machine->port_in1=(1<<3) | keys;
+            machine_run_frame(machine);
+        }
+
+        session->frame++;
+
+        if(predicate>=0){
+            ramsearch_filter(session->search, session->machines, predicate, value);
+        }
+
+        if(session->live){
+            next_frame_us+=1000000 / FPS;
+
+            uint64_t now=latency_now_us();
+            if(next_frame_us>now){
+                usleep(next_frame_us-now);
+            }
+        }
+
+        //Refresh the watch line at most 30 times a second
+        if(session->tty && latency_now_us()-last_print_us>=1000000 / 30){
+            print_watches(session, 1);
+            last_print_us=latency_now_us();
+        }
+    }
+
+    if(session->tty && session->search->num_watches){
+        printf("\n");
+    }
+    else{
+        print_watches(session, 0);
+    }
+
+    if(predicate>=0){
+        printf("%d candidates\n", session->search->num_candidates);
+    }
+}
+
+static void list_candidates(session_t* session, int count){
+    ramsearch_t* search=session->search;
+    int shown=0;
+
+    for(int addr=ramsearch_next(search, RAMSEARCH_START); addr>=0 && shown<count;
+        addr=ramsearch_next(search, addr+1), shown++){
+        printf("%04x:", addr);
+
+        for(int i=0; i<session->num_instances; i++){
+            printf("  %02x -> %02x", search->previous[i][addr-RAMSEARCH_START],
+                   session->machines[i]->machine_mem[addr]);
+        }
+        printf("\n");
+    }
+
+    if(search->num_candidates>shown){
+        printf("... %d more\n", search->num_candidates-shown);
+    }
+}
+
+static void set_keys(session_t* session, const char* keys){
+    session->keys=0;
+    session->random_keys=0;
+
+    for(; *keys; keys++){
+        if(*keys=='?'){
+            session->random_keys=1;
+        }
+
+        for(size_t k=0; k<sizeof(key_bits)/sizeof(key_bits[0]); k++){
+            if(*keys==key_bits[k].name){
+                session->keys|=key_bits[k].bit;
+            }
+        }
+    }
+}
+
+static void console(session_t* session){
+    char line[128];
+
+    while(1){
+        printf("(search %d) ", session->search->num_candidates);
+        fflush(stdout);
+
+        if(!fgets(line, sizeof(line), stdin)){
+            return;
+        }
+
+        char cmd[8]="";
+        char arg1[16]="";
+        char arg2[8]="";
+        char arg3[8]="";
+        int num_args=sscanf(line, "%7s %15s %7s %7s", cmd, arg1, arg2, arg3);
+
+        if(strcmp(cmd, "q")==0){
+            return;
+        }
+        else if(strcmp(cmd, "r")==0){
+            long frames=(num_args>=2) ? strtol(arg1, NULL, 16) : 1;
+            int predicate=(num_args>=3) ? parse_predicate(arg2) : -1;
+            int value=(num_args>=4) ? (int)strtol(arg3, NULL, 16) : -1;
+
+            run_frames(session, frames, predicate, value);
+        }
+        else if(parse_predicate(cmd)>=0){
+            int value=(num_args>=2) ? (int)strtol(arg1, NULL, 16) : -1;
+
+            printf("%d candidates\n", ramsearch_filter(session->search, session->machines, parse_predicate(cmd), value));
+        }
+        else if(strcmp(cmd, "i")==0 && num_args>=2){
+            set_keys(session, arg1);
+        }
+        else if(strcmp(cmd, "l")==0){
+            list_candidates(session, (num_args>=2) ? (int)strtol(arg1, NULL, 16) : 32);
+        }
+        else if(strcmp(cmd, "n")==0){
+            ramsearch_reset(session->search, session->machines);
+        }
+        else if(strcmp(cmd, "w")==0 && num_args>=2){
+            if(ramsearch_watch(session->search, strtol(arg1, NULL, 16), (num_args>=3) ? atoi(arg2) : 1)<0){
+                printf("Cannot watch %s\n", arg1);
+            }
+            print_watches(session, 0);
+        }
+        else if(strcmp(cmd, "wd")==0 && num_args>=2){
+            ramsearch_unwatch(session->search, strtol(arg1, NULL, 16));
+        }
+        else if(cmd[0]){
+            printf("Commands: r [frames] [pred [value]], = ! > < [value], i keys, l [count], n,\n"
+                   "          w addr [2], wd addr, q (numbers are hex)\n");
+        }
+    }
+}
+
+int main(int argc, char* argv[]){
+    char* rom_dir=NULL;
+    session_t session;
+
+    memset(&session, 0, sizeof(session));
+    session.num_instances=1;
+
+    for(int i=1; i<argc; i++){
+        if(strcmp(argv[i], "-n")==0 && i+1<argc){
+            session.num_instances=atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-l")==0){
+            session.live=1;
+        }
+        else if(argv[i][0]!='-'){
+            rom_dir=argv[i];
+        }
+        else{
+            printf("Usage: %s [-n instances] [-l] [rom_dir]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if(session.num_instances<1){
+        printf("Need at least one instance\n");
+        return 1;
+    }
+
+    char rom_path[ROM_PATH_MAX]="";
+
+#ifndef EMBED_ROMS
+    if(rom_find_dir(rom_dir, rom_path, sizeof(rom_path))<0){
+        printf("Cannot find the ROM directory\n");
+        return 1;
+    }
+#else
+    (void)rom_dir;
+#endif
+
+    session.machines=calloc(session.num_instances, sizeof(machine_t*));
+    session.seeds=calloc(session.num_instances, sizeof(unsigned int));
+
+    for(int i=0; i<session.num_instances; i++){
+        session.machines[i]=init_machine();
+        session.seeds[i]=i+1;
+
+        if(load_game(session.machines[i], rom_path)<0){
+            return 1;
+        }
+    }
+
+    session.tty=isatty(STDOUT_FILENO);
+    session.search=ramsearch_init(session.num_instances);
+    ramsearch_reset(session.search, session.machines);
+
+    console(&session);
+
+    for(int i=0; i<session.num_instances; i++){
+        destroy_machine(session.machines[i]);
+    }
+
+    ramsearch_destroy(session.search);
+    free(session.machines);
+    free(session.seeds);
+
+    return 0;
+}
@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "recorder.h"
+
+/*Offline player for recordings written with --record. Rebuilds every frame from the
+delta stream and writes the selected ones as PPM images or a Y4M video.
+
+Usage: recexport [-s start] [-n count] [-k step] [-p prefix] [-y file.y4m] file
+  -s start       first frame to export
+  -n count       export at most count frames
+  -k step        export every step-th frame
+  -p prefix      write each frame to prefixNNNNNN.ppm
+  -y file        write the frames to a Y4M video (4:4:4, use - for stdout)
+Without -p or -y it only prints a summary of the recording*/
+
+static uint8_t rgb[SCREEN_HEIGHT][SCREEN_WIDTH][3];
+
+//Same conversion as machine_update_scanline(), with the overlay from the recording
+static void render_frame(const recorder_header_t* header, const uint8_t* vram){
+    for(int line=0; line<SCREEN_WIDTH; line++){
+        const uint8_t* column=vram + line*0x20 + 0x1F;
+
+        for(int y=0; y<SCREEN_HEIGHT; y+=8){
+            uint8_t data_byte=*column--;
+            const uint8_t* color=header->overlay[y / 8];
+
+            for(int bit=0; bit<8; bit++){
+                uint8_t* pixel=rgb[y+bit][line];
+                int on=(data_byte<<bit) & 0x80;
+
+                pixel[R]=on ? color[R] : 0;
+                pixel[G]=on ? color[G] : 0;
+                pixel[B]=on ? color[B] : 0;
+            }
+        }
+    }
+}
+
+static int write_ppm(const char* prefix, uint64_t frame){
+    char path[4096];
+    snprintf(path, sizeof(path), "%s%06llu.ppm", prefix, (unsigned long long)frame);
+
+    FILE* fp=fopen(path, "wb");
+    if(!fp){
+        printf("Cannot create %s\n", path);
+        return -1;
+    }
+
+    fprintf(fp, "P6\n%d %d\n255\n", SCREEN_WIDTH, SCREEN_HEIGHT);
+    fwrite(rgb, 1, sizeof(rgb), fp);
+    fclose(fp);
+
+    return 0;
+}
+
+static uint8_t clamp(int value){
+    return value<0 ? 0 : (value>255 ? 255 : value);
+}
+
+//BT.601 full-range conversion, the overlay only has a handful of colours so this is not hot
+static void write_y4m_frame(FILE* fp){
+    static uint8_t planes[3][SCREEN_HEIGHT][SCREEN_WIDTH];
+
+    for(int y=0; y<SCREEN_HEIGHT; y++){
+        for(int x=0; x<SCREEN_WIDTH; x++){
+            int r=rgb[y][x][R], g=rgb[y][x][G], b=rgb[y][x][B];
+
+            planes[0][y][x]=(77*r + 150*g + 29*b + 128) >> 8;
+            planes[1][y][x]=clamp(((-43*r - 85*g + 128*b + 128) >> 8) + 128);
+            planes[2][y][x]=clamp(((128*r - 107*g - 21*b + 128) >> 8) + 128);
+        }
+    }
+
+    fputs("FRAME\n", fp);
+    fwrite(planes, 1, sizeof(planes), fp);
+}
+
+int main(int argc, char* argv[]){
+    unsigned long long start=0;
+    unsigned long long limit=~0ULL;
+    unsigned long long step=1;
+    char* prefix=NULL;
+    char* y4m_path=NULL;
+    char* path=NULL;
+
+    for(int i=1; i<argc; i++){
+        if(strcmp(argv[i], "-s")==0 && i+1<argc){
+            start=strtoull(argv[++i], NULL, 0);
+        }
+        else if(strcmp(argv[i], "-n")==0 && i+1<argc){
+            limit=strtoull(argv[++i], NULL, 0);
+        }
+        else if(strcmp(argv[i], "-k")==0 && i+1<argc){
+            step=strtoull(argv[++i], NULL, 0);
+        }
+        else if(strcmp(argv[i], "-p")==0 && i+1<argc){
+            prefix=argv[++i];
+        }
+        else if(strcmp(argv[i], "-y")==0 && i+1<argc){
+            y4m_path=argv[++i];
+        }
+        else if(argv[i][0]!='-' && !path){
+            path=argv[i];
+        }
+        else{
+            printf("Usage: %s [-s start] [-n count] [-k step] [-p prefix] [-y file.y4m] file\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if(!path || step==0){
+        printf("Usage: %s [-s start] [-n count] [-k step] [-p prefix] [-y file.y4m] file\n", argv[0]);
+        return 1;
+    }
+
+    FILE* fp=fopen(path, "rb");
+    if(!fp){
+        printf("Cannot open %s\n", path);
+        return 1;
+    }
+
+    recorder_header_t header;
+    if(fread(&header, sizeof(header), 1, fp)!=1 || memcmp(header.magic, RECORDER_MAGIC, sizeof(header.magic))!=0){
+        printf("%s is not a recording\n", path);
+        return 1;
+    }
+
+    if(header.version!=RECORDER_VERSION || header.width!=SCREEN_WIDTH ||
+       header.height!=SCREEN_HEIGHT || header.vram_size!=VRAM_SIZE){
+        printf("%s: unsupported recording version %u (%ux%u)\n", path, header.version, header.width, header.height);
+        return 1;
+    }
+
+    FILE* y4m=NULL;
+    if(y4m_path){
+        y4m=strcmp(y4m_path, "-")==0 ? stdout : fopen(y4m_path, "wb");
+
+        if(!y4m){
+            printf("Cannot create %s\n", y4m_path);
+            return 1;
+        }
+
+        fprintf(y4m, "YUV4MPEG2 W%d H%d F%u:1 Ip A1:1 C444\n", SCREEN_WIDTH, SCREEN_HEIGHT, header.fps);
+    }
+
+    uint8_t vram[VRAM_SIZE]={0};
+    uint8_t record[RECORDER_MAX_FRAME];
+    uint64_t frame=0, changed=0, exported=0, bytes=0;
+    uint16_t length;
+
+    while(fread(&length, sizeof(length), 1, fp)==1){
+        if(length>RECORDER_MAX_FRAME || fread(record, 1, length, fp)!=length ||
+           recorder_decode(vram, record, length)<0){
+            printf("Corrupt frame %llu\n", (unsigned long long)frame);
+            return 1;
+        }
+
+        changed+=length ? 1 : 0;
+        bytes+=sizeof(length)+length;
+
+        if(frame>=start && (frame-start) % step==0 && exported<limit && (prefix || y4m)){
+            render_frame(&header, vram);
+
+            if(prefix && write_ppm(prefix, frame)<0){
+                return 1;
+            }
+            if(y4m){
+                write_y4m_frame(y4m);
+            }
+
+            exported++;
+        }
+
+        frame++;
+    }
+
+    fclose(fp);
+    if(y4m && y4m!=stdout){
+        fclose(y4m);
+    }
+
+    //Keep stdout clean when it carries the video
+    FILE* out=(y4m==stdout) ? stderr : stdout;
+    fprintf(out, "%llu frames (%.1f s), %llu changed, %llu bytes of frame data (%.1f per frame)\n",
+            (unsigned long long)frame, (double)frame / header.fps, (unsigned long long)changed,
+            (unsigned long long)bytes, frame ? (double)bytes / frame : 0.0);
+    if(exported){
+        fprintf(out, "Exported %llu frames\n", (unsigned long long)exported);
+    }
+
+    return 0;
+}
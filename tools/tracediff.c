@@ -0,0 +1,254 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "trace.h"
+#include "disassembler.h"
+
+#define CHUNK_RECORDS		(1 << 20)	//Records compared per memcmp (20 MB)
+#define MASKED_RECORDS		4096		//Records copied with the cycle counter cleared per memcmp with -C
+#define DEFAULT_CONTEXT		8
+
+/*Finds the first instruction where two execution traces disagree.
+
+Usage: tracediff [-c context] [-C] trace_a trace_b
+  -c context   number of records shown before the divergence (default 8)
+  -C           ignore the cycle counter, for engines with different timing
+
+Both files are mapped read-only and compared a chunk at a time with memcmp, which
+glibc vectorizes, so only the chunk containing the divergence is scanned record by record.
+With -C small blocks are first copied with their cycle counters cleared, so they can be
+compared the same way*/
+
+typedef struct{
+    const char* path;
+    const trace_record_t* records;
+    size_t num_records;
+    size_t map_size;
+    void* map;
+} trace_file_t;
+
+static int map_trace(trace_file_t* trace, const char* path){
+    int fd=open(path, O_RDONLY);
+    struct stat st;
+
+    trace->path=path;
+
+    if(fd<0 || fstat(fd, &st)<0){
+        fprintf(stderr, "Cannot open %s\n", path);
+        return 0;
+    }
+
+    if((size_t)st.st_size<sizeof(trace_header_t)){
+        fprintf(stderr, "%s is too short to be a trace\n", path);
+        close(fd);
+        return 0;
+    }
+
+    trace->map_size=st.st_size;
+    trace->map=mmap(NULL, trace->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if(trace->map==MAP_FAILED){
+        fprintf(stderr, "Cannot map %s\n", path);
+        return 0;
+    }
+
+    madvise(trace->map, trace->map_size, MADV_SEQUENTIAL);
+
+    const trace_header_t* header=trace->map;
+    if(memcmp(header->magic, TRACE_MAGIC, 8)!=0 || header->version!=TRACE_VERSION
+       || header->record_size!=sizeof(trace_record_t)){
+        fprintf(stderr, "%s is not a version %d trace file\n", path, TRACE_VERSION);
+        return 0;
+    }
+
+    trace->records=(const trace_record_t*)(header+1);
+    trace->num_records=(trace->map_size-sizeof(trace_header_t)) / sizeof(trace_record_t);
+
+    return 1;
+}
+
+static int records_equal(const trace_record_t* a, const trace_record_t* b, int ignore_cycles){
+    if(ignore_cycles){
+        size_t skip=offsetof(trace_record_t, pc);
+        return memcmp((const uint8_t*)a+skip, (const uint8_t*)b+skip, sizeof(trace_record_t)-skip)==0;
+    }
+
+    return memcmp(a, b, sizeof(trace_record_t))==0;
+}
+
+//Returns the index of the first differing record in a range memcmp found a difference in
+static size_t scan_records(const trace_record_t* a, const trace_record_t* b, size_t index, size_t n, int ignore_cycles){
+    for(size_t i=index; i<index+n; i++){
+        if(!records_equal(&a[i], &b[i], ignore_cycles)){
+            return i;
+        }
+    }
+
+    return index+n;
+}
+
+//Compares n records with the cycle counters masked out, a block of copies at a time
+static size_t find_divergence_masked(const trace_record_t* a, const trace_record_t* b, size_t index, size_t n){
+    static trace_record_t masked_a[MASKED_RECORDS], masked_b[MASKED_RECORDS];
+    size_t end=index+n;
+
+    while(index<end){
+        size_t m=(end-index<MASKED_RECORDS) ? end-index : MASKED_RECORDS;
+
+        memcpy(masked_a, &a[index], m * sizeof(trace_record_t));
+        memcpy(masked_b, &b[index], m * sizeof(trace_record_t));
+        for(size_t i=0; i<m; i++){
+            masked_a[i].cycle=0;
+            masked_b[i].cycle=0;
+        }
+
+        if(memcmp(masked_a, masked_b, m * sizeof(trace_record_t))!=0){
+            return scan_records(a, b, index, m, 1);
+        }
+
+        index+=m;
+    }
+
+    return end;
+}
+
+//Returns the index of the first differing record, or count if the ranges are equal
+static size_t find_divergence(const trace_record_t* a, const trace_record_t* b, size_t count, int ignore_cycles){
+    size_t index=0;
+
+    while(index<count){
+        size_t n=(count-index<CHUNK_RECORDS) ? count-index : CHUNK_RECORDS;
+
+        //Identical chunks are identical without the cycle counters too
+        if(memcmp(&a[index], &b[index], n * sizeof(trace_record_t))!=0){
+            size_t found=ignore_cycles ? find_divergence_masked(a, b, index, n)
+                                       : scan_records(a, b, index, n, 0);
+            if(found<index+n){
+                return found;
+            }
+        }
+
+        index+=n;
+    }
+
+    return count;
+}
+
+static void print_record(const char* tag, size_t index, const trace_record_t* record){
+    uint8_t bytes[3]={record->opcode, record->operands[0], record->operands[1]};
+    char text[32];
+
+    i8080_disasm(text, sizeof(text), bytes, sizeof(bytes), 0);
+
+    printf("%s %12zu %10u  %04x  %02x %02x %02x  %-18s A=%02x B=%02x C=%02x D=%02x E=%02x H=%02x L=%02x SP=%04x PSW=%02x%s\n",
+           tag, index, record->cycle, record->pc, bytes[0], bytes[1], bytes[2], text,
+           record->a, record->b, record->c, record->d, record->e, record->h, record->l, record->sp,
+           record->psw, (record->flags & TRACE_IE) ? " EI" : "");
+}
+
+//Names every field that differs between the two records
+static void print_field_diff(const trace_record_t* a, const trace_record_t* b, int ignore_cycles){
+    printf("Differing fields:");
+
+#define FIELD(name, fmt, expr_a, expr_b) \
+    if((expr_a)!=(expr_b)) printf(" %s(" fmt " vs " fmt ")", name, expr_a, expr_b);
+
+    if(!ignore_cycles) FIELD("cycle", "%u", a->cycle, b->cycle);
+    FIELD("PC", "%04x", a->pc, b->pc);
+    FIELD("SP", "%04x", a->sp, b->sp);
+    FIELD("opcode", "%02x", a->opcode, b->opcode);
+    FIELD("op1", "%02x", a->operands[0], b->operands[0]);
+    FIELD("op2", "%02x", a->operands[1], b->operands[1]);
+    FIELD("PSW", "%02x", a->psw, b->psw);
+    FIELD("A", "%02x", a->a, b->a);
+    FIELD("B", "%02x", a->b, b->b);
+    FIELD("C", "%02x", a->c, b->c);
+    FIELD("D", "%02x", a->d, b->d);
+    FIELD("E", "%02x", a->e, b->e);
+    FIELD("H", "%02x", a->h, b->h);
+    FIELD("L", "%02x", a->l, b->l);
+    FIELD("IE", "%d", a->flags & TRACE_IE, b->flags & TRACE_IE);
+
+#undef FIELD
+
+    printf("\n");
+}
+
+int main(int argc, char* argv[]){
+    size_t context=DEFAULT_CONTEXT;
+    int ignore_cycles=0;
+    char* paths[2];
+    int num_paths=0;
+
+    for(int i=1; i<argc; i++){
+        if(strcmp(argv[i], "-c")==0 && i+1<argc){
+            context=strtoul(argv[++i], NULL, 0);
+        }
+        else if(strcmp(argv[i], "-C")==0){
+            ignore_cycles=1;
+        }
+        else if(argv[i][0]!='-' && num_paths<2){
+            paths[num_paths++]=argv[i];
+        }
+        else{
+            num_paths=0;
+            break;
+        }
+    }
+
+    if(num_paths!=2){
+        fprintf(stderr, "Usage: %s [-c context] [-C] trace_a trace_b\n", argv[0]);
+        return 2;
+    }
+
+    trace_file_t a, b;
+    if(!map_trace(&a, paths[0]) || !map_trace(&b, paths[1])){
+        return 2;
+    }
+
+    size_t common=(a.num_records<b.num_records) ? a.num_records : b.num_records;
+    size_t index=find_divergence(a.records, b.records, common, ignore_cycles);
+
+    if(index==common){
+        if(a.num_records==b.num_records){
+            printf("Traces are identical (%zu records)\n", common);
+            return 0;
+        }
+
+        printf("Traces agree for %zu records, then %s ends (%zu vs %zu records)\n", common,
+               (a.num_records<b.num_records) ? a.path : b.path, a.num_records, b.num_records);
+        return 1;
+    }
+
+    printf("First divergence at record %zu\n\n", index);
+
+    size_t first=(index>context) ? index-context : 0;
+    printf("      record      cycle    PC  bytes     instruction\n");
+    for(size_t i=first; i<index; i++){
+        print_record("  ", i, &a.records[i]);
+    }
+    print_record("A>", index, &a.records[index]);
+    print_record("B>", index, &b.records[index]);
+
+    //The state before index is equal, so the previous instruction is what produced the difference
+    printf("\n");
+    print_field_diff(&a.records[index], &b.records[index], ignore_cycles);
+    if(index>0){
+        const trace_record_t* culprit=&a.records[index-1];
+        uint8_t bytes[3]={culprit->opcode, culprit->operands[0], culprit->operands[1]};
+        char text[32];
+
+        i8080_disasm(text, sizeof(text), bytes, sizeof(bytes), 0);
+        printf("Last common instruction: %04x %s (HL=%02x%02x DE=%02x%02x BC=%02x%02x SP=%04x)\n",
+               culprit->pc, text, culprit->h, culprit->l, culprit->d, culprit->e, culprit->b, culprit->c, culprit->sp);
+    }
+
+    return 1;
+}
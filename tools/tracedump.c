@@ -0,0 +1,166 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace.h"
+#include "disassembler.h"
+#include "i8080_opcodes.h"
+
+#define READ_BATCH		65536		//Records read per fread
+#define TOP_COUNT		16
+
+/*Offline decoder for traces written with --trace.
+
+Usage: tracedump [-r start-end] [-n count] [-s] [-q] file
+  -r start-end   only records whose PC is in [start, end]
+  -n count       stop after printing count records
+  -s             print a summary (instruction mix, hottest PCs, cycle span)
+  -q             do not print the records themselves*/
+
+typedef struct{
+    uint64_t count;
+    int key;
+} counter_t;
+
+static int compare_counters(const void* a, const void* b){
+    uint64_t x=((const counter_t*)a)->count;
+    uint64_t y=((const counter_t*)b)->count;
+
+    return (x<y)-(x>y);
+}
+
+static void print_record(const trace_record_t* record){
+    uint8_t bytes[3]={record->opcode, record->operands[0], record->operands[1]};
+    char text[32];
+
+    i8080_disasm(text, sizeof(text), bytes, sizeof(bytes), 0);
+
+    printf("%10u  %04x  %-18s A=%02x B=%02x C=%02x D=%02x E=%02x H=%02x L=%02x SP=%04x  %c%c%c%c%c %s\n",
+           record->cycle, record->pc, text,
+           record->a, record->b, record->c, record->d, record->e, record->h, record->l, record->sp,
+           (record->psw & 0x80) ? 'S' : '-', (record->psw & 0x40) ? 'Z' : '-',
+           (record->psw & 0x10) ? 'A' : '-', (record->psw & 0x04) ? 'P' : '-',
+           (record->psw & 0x01) ? 'C' : '-', (record->flags & TRACE_IE) ? "EI" : "");
+}
+
+int main(int argc, char* argv[]){
+    unsigned long range_start=0, range_end=0xFFFF;
+    unsigned long long limit=~0ULL;
+    int summary=0;
+    int quiet=0;
+    char* path=NULL;
+
+    for(int i=1; i<argc; i++){
+        if(strcmp(argv[i], "-r")==0 && i+1<argc){
+            char* end;
+            range_start=strtoul(argv[++i], &end, 0);
+            range_end=(*end=='-') ? strtoul(end+1, NULL, 0) : range_start;
+        }
+        else if(strcmp(argv[i], "-n")==0 && i+1<argc){
+            limit=strtoull(argv[++i], NULL, 0);
+        }
+        else if(strcmp(argv[i], "-s")==0){
+            summary=1;
+        }
+        else if(strcmp(argv[i], "-q")==0){
+            quiet=1;
+        }
+        else if(argv[i][0]!='-' && !path){
+            path=argv[i];
+        }
+        else{
+            path=NULL;
+            break;
+        }
+    }
+
+    if(!path){
+        fprintf(stderr, "Usage: %s [-r start-end] [-n count] [-s] [-q] file\n", argv[0]);
+        return 1;
+    }
+
+    FILE* fp=fopen(path, "rb");
+    if(!fp){
+        fprintf(stderr, "Cannot open %s\n", path);
+        return 1;
+    }
+
+    trace_header_t header;
+    if(fread(&header, sizeof(header), 1, fp)!=1 || memcmp(header.magic, TRACE_MAGIC, 8)!=0
+       || header.version!=TRACE_VERSION || header.record_size!=sizeof(trace_record_t)){
+        fprintf(stderr, "%s is not a version %d trace file\n", path, TRACE_VERSION);
+        fclose(fp);
+        return 1;
+    }
+
+    static trace_record_t records[READ_BATCH];
+    static counter_t pc_counts[0x10000];
+    static counter_t opcode_counts[256];
+    uint64_t total=0, matched=0, printed=0;
+    uint32_t first_cycle=0, last_cycle=0;
+    size_t n;
+
+    for(int i=0; i<0x10000; i++){
+        pc_counts[i].key=i;
+    }
+    for(int i=0; i<256; i++){
+        opcode_counts[i].key=i;
+    }
+
+    while((n=fread(records, sizeof(trace_record_t), READ_BATCH, fp))>0){
+        for(size_t i=0; i<n; i++){
+            const trace_record_t* record=&records[i];
+
+            if(total==0){
+                first_cycle=record->cycle;
+            }
+            last_cycle=record->cycle;
+            total++;
+
+            if(record->pc<range_start || record->pc>range_end){
+                continue;
+            }
+            matched++;
+
+            if(summary){
+                pc_counts[record->pc].count++;
+                opcode_counts[record->opcode].count++;
+            }
+
+            if(!quiet && printed<limit){
+                print_record(record);
+                printed++;
+            }
+        }
+
+        if(!summary && printed>=limit){
+            break;
+        }
+    }
+
+    fclose(fp);
+
+    if(summary){
+        printf("\n%llu records, %llu in PC range $%04lx-$%04lx, cycles %u..%u (%u elapsed, wraps at 2^32)\n",
+               (unsigned long long)total, (unsigned long long)matched, range_start, range_end,
+               first_cycle, last_cycle, last_cycle-first_cycle);
+
+        qsort(pc_counts, 0x10000, sizeof(counter_t), compare_counters);
+        qsort(opcode_counts, 256, sizeof(counter_t), compare_counters);
+
+        printf("\nHottest PCs:\n");
+        for(int i=0; i<TOP_COUNT && pc_counts[i].count>0; i++){
+            printf("  %04x  %12llu  %5.2f%%\n", pc_counts[i].key, (unsigned long long)pc_counts[i].count,
+                   100.0 * pc_counts[i].count / matched);
+        }
+
+        printf("\nInstruction mix:\n");
+        for(int i=0; i<TOP_COUNT && opcode_counts[i].count>0; i++){
+            const i8080_opcode_t* info=&i8080_opcodes[opcode_counts[i].key];
+            printf("  %02x  %-5s %-6s %12llu  %5.2f%%\n", opcode_counts[i].key, info->mnemonic, info->operands,
+                   (unsigned long long)opcode_counts[i].count, 100.0 * opcode_counts[i].count / matched);
+        }
+    }
+
+    return 0;
+}